@@ -182,6 +182,23 @@ typedef struct  q_xyz_quat_struct {
     q_type     quat;  /* rotation    */
 } q_xyz_quat_type;
 
+/* many quaternions or vectors stored struct-of-arrays, for the q_batch
+ *  routines:  quaternion i is (x[i], y[i], z[i], w[i]).  The arrays are
+ *  the caller's and need no special alignment.
+ */
+typedef struct  q_batch_struct {
+    double *x, *y, *z, *w;
+} q_batch_type;
+
+typedef struct  q_vec_batch_struct {
+    double *x, *y, *z;
+} q_vec_batch_type;
+
+/* instruction sets the q_batch routines can use; see q_batch_simd_level() */
+#define Q_BATCH_SCALAR  0
+#define Q_BATCH_SSE2    1
+#define Q_BATCH_AVX     2
+
 
 
 /*****************************************************************************
@@ -347,6 +364,44 @@ void q_from_ogl_matrix (q_type destQuat, const qogl_matrix_type matrix);
 void q_to_ogl_matrix (qogl_matrix_type matrix, const q_type srcQuat);
 
 
+/*****************************************************************************
+ *
+    batch operations:  the same as the routines above, done for count
+    quaternions (or vectors) at once.  Element i of the result is computed
+    from element i of each argument.  A destination may be the same arrays
+    as a source, but must not otherwise overlap it.
+ *
+ *****************************************************************************/
+
+/* which instruction set the batch routines use:  the best the CPU has
+ *  (Q_BATCH_AVX, Q_BATCH_SSE2 or Q_BATCH_SCALAR) unless set otherwise.
+ *  Setting asks for a level, gets the nearest one the CPU can do and
+ *  returns it.
+ */
+int q_batch_simd_level (void);
+int q_batch_set_simd_level (int level);
+
+/* destQuat[i] = qLeft[i] * qRight[i], as q_mult() */
+void q_batch_mult (const q_batch_type *destQuat, const q_batch_type *qLeft,
+                   const q_batch_type *qRight, int count);
+
+/* destVec[i] = q[i] * vec[i] * q[i](inverse), as q_xform() */
+void q_batch_xform (const q_vec_batch_type *destVec, const q_batch_type *q,
+                    const q_vec_batch_type *vec, int count);
+
+/* slerp from startQuat[i] to endQuat[i] by t[i], as q_slerp() */
+void q_batch_slerp (const q_batch_type *destQuat, const q_batch_type *startQuat,
+                    const q_batch_type *endQuat, const double *t, int count);
+
+/* normalize each quaternion, as q_normalize() */
+void q_batch_normalize (const q_batch_type *destQuat,
+                        const q_batch_type *srcQuat, int count);
+
+/* destMatrices[i] from srcQuat[i], as q_to_col_matrix() */
+void q_batch_to_col_matrix (q_matrix_type *destMatrices,
+                            const q_batch_type *srcQuat, int count);
+
+
 /*****************************************************************************
  *
     strictly vector operations
@@ -0,0 +1,742 @@
+/*****************************************************************************
+ *
+    quatbatch.c-  quaternion routines that work on many quaternions at once.
+
+    The quaternions (and vectors) are stored struct-of-arrays: one array
+    for each component (see q_batch_type in quat.h), so that the same
+    component of neighboring quaternions is contiguous in memory and can
+    be loaded into one SSE2 or AVX register.  Each routine has a plain C
+    version and, on x86, SSE2 (two at a time) and AVX (four at a time)
+    versions; which one is used is picked at run time from what the CPU
+    supports, and can be overridden with q_batch_set_simd_level().  The
+    SIMD versions do as many as fit in whole registers and leave the rest
+    to the plain C version.
+
+    (see quat.h for revision history and more documentation.)
+ *
+ *****************************************************************************/
+
+
+#include "quat.h"
+
+#include <math.h>                       // for sqrt, sin, acos
+
+/* Which instruction sets we can compile for here.  SSE2 is part of every
+ * x86-64 CPU, so is used whenever the compiler is allowed to.  The AVX
+ * routines are compiled for AVX one function at a time (so the rest of the
+ * library doesn't need it) and only called if the CPU turns out to have it.
+ */
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) ||           \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define Q_BATCH_HAVE_SSE2
+#include <emmintrin.h>
+#if (defined(__GNUC__) && ((__GNUC__ >= 5) || defined(__clang__))) ||         \
+    (defined(_MSC_VER) && (_MSC_VER >= 1700))
+#define Q_BATCH_HAVE_AVX
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define Q_BATCH_AVX_FUNCTION
+#else
+#define Q_BATCH_AVX_FUNCTION __attribute__((target("avx")))
+#endif
+#endif
+#endif
+
+
+/*****************************************************************************
+ *
+    picking which version to use
+ *
+ *****************************************************************************/
+
+/* What the CPU we are running on can do, found the first time we're asked. */
+static int q_batch_supported_level(void)
+{
+   static int supported = -1;
+
+   if (supported < 0) {
+      supported = Q_BATCH_SCALAR;
+#ifdef Q_BATCH_HAVE_SSE2
+      supported = Q_BATCH_SSE2;
+#ifdef Q_BATCH_HAVE_AVX
+#if defined(_MSC_VER)
+      {
+         /* AVX needs both the CPU (CPUID bit 28) and the operating system,
+          * which says it saves the AVX registers with OSXSAVE (bit 27) and
+          * then in XCR0. */
+         int info[4];
+         __cpuid(info, 1);
+         if ( (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+              ((_xgetbv(0) & 6) == 6) ) {
+            supported = Q_BATCH_AVX;
+         }
+      }
+#else
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx")) {
+         supported = Q_BATCH_AVX;
+      }
+#endif
+#endif
+#endif
+   }
+   return supported;
+}
+
+static int q_batch_level = -1;
+
+static int q_batch_current_level(void)
+{
+   if (q_batch_level < 0) {
+      q_batch_level = q_batch_supported_level();
+   }
+   return q_batch_level;
+}
+
+int q_batch_simd_level(void)
+{
+   return q_batch_current_level();
+}
+
+int q_batch_set_simd_level(int level)
+{
+   int supported = q_batch_supported_level();
+
+   if (level < Q_BATCH_SCALAR) {
+      level = Q_BATCH_SCALAR;
+   }
+   q_batch_level = Q_MIN(level, supported);
+   return q_batch_level;
+}
+
+
+/*****************************************************************************
+ *
+    plain C versions, which do elements first through count-1.  They are
+    used for whatever doesn't fill a whole register, and for everything
+    when there is no SIMD.
+ *
+ *****************************************************************************/
+
+static void q_batch_mult_scalar(const q_batch_type *dest,
+                                const q_batch_type *qLeft,
+                                const q_batch_type *qRight,
+                                int first, int count)
+{
+   int i;
+   double lx, ly, lz, lw, rx, ry, rz, rw;
+
+   for (i = first; i < count; i++) {
+      lx = qLeft->x[i];  ly = qLeft->y[i];  lz = qLeft->z[i];  lw = qLeft->w[i];
+      rx = qRight->x[i]; ry = qRight->y[i]; rz = qRight->z[i]; rw = qRight->w[i];
+      dest->w[i] = lw*rw - lx*rx - ly*ry - lz*rz;
+      dest->x[i] = lw*rx + lx*rw + ly*rz - lz*ry;
+      dest->y[i] = lw*ry + ly*rw + lz*rx - lx*rz;
+      dest->z[i] = lw*rz + lz*rw + lx*ry - ly*rx;
+   }
+}
+
+/* q * v * q(inverse), written out so that q need not be unit length:
+ *  ( (w*w - u.u) v + 2 (u.v) u + 2 w (u x v) ) / |q|^2, where u is the
+ *  vector part of q.
+ */
+static void q_batch_xform_scalar(const q_vec_batch_type *destVec,
+                                 const q_batch_type *q,
+                                 const q_vec_batch_type *vec,
+                                 int first, int count)
+{
+   int i;
+   double qx, qy, qz, qw, vx, vy, vz, uu, uv, scale, a, b, c;
+
+   for (i = first; i < count; i++) {
+      qx = q->x[i]; qy = q->y[i]; qz = q->z[i]; qw = q->w[i];
+      vx = vec->x[i]; vy = vec->y[i]; vz = vec->z[i];
+      uu = qx*qx + qy*qy + qz*qz;
+      uv = qx*vx + qy*vy + qz*vz;
+      scale = 1.0 / (qw*qw + uu);
+      a = (qw*qw - uu) * scale;
+      b = 2.0 * uv * scale;
+      c = 2.0 * qw * scale;
+      destVec->x[i] = a*vx + b*qx + c*(qy*vz - qz*vy);
+      destVec->y[i] = a*vy + b*qy + c*(qz*vx - qx*vz);
+      destVec->z[i] = a*vz + b*qz + c*(qx*vy - qy*vx);
+   }
+}
+
+/* The scales for one slerp, as in q_slerp(), given the cosine of the angle
+ * between the ends after taking the shorter path (so it is >= 0).
+ */
+static void q_batch_slerp_scales(double *startScale, double *endScale,
+                                 double cosOmega, double t)
+{
+   double omega, sinOmega;
+
+   if ( (1.0 - cosOmega) > Q_EPSILON ) {
+      omega = acos(cosOmega);
+      sinOmega = sin(omega);
+      *startScale = sin((1.0 - t)*omega) / sinOmega;
+      *endScale = sin(t*omega) / sinOmega;
+   } else {
+      /* ends very close */
+      *startScale = 1.0 - t;
+      *endScale = t;
+   }
+}
+
+static void q_batch_slerp_scalar(const q_batch_type *destQuat,
+                                 const q_batch_type *startQuat,
+                                 const q_batch_type *endQuat,
+                                 const double *t, int first, int count)
+{
+   int i;
+   double cosOmega, startScale, endScale;
+
+   for (i = first; i < count; i++) {
+      cosOmega = startQuat->x[i]*endQuat->x[i] + startQuat->y[i]*endQuat->y[i] +
+         startQuat->z[i]*endQuat->z[i] + startQuat->w[i]*endQuat->w[i];
+      q_batch_slerp_scales(&startScale, &endScale, fabs(cosOmega), t[i]);
+      /* go from the negative of the start if that is the shorter path */
+      if (cosOmega < 0.0) {
+         startScale = -startScale;
+      }
+      destQuat->x[i] = startScale*startQuat->x[i] + endScale*endQuat->x[i];
+      destQuat->y[i] = startScale*startQuat->y[i] + endScale*endQuat->y[i];
+      destQuat->z[i] = startScale*startQuat->z[i] + endScale*endQuat->z[i];
+      destQuat->w[i] = startScale*startQuat->w[i] + endScale*endQuat->w[i];
+   }
+}
+
+static void q_batch_normalize_scalar(const q_batch_type *destQuat,
+                                     const q_batch_type *srcQuat,
+                                     int first, int count)
+{
+   int i;
+   double x, y, z, w, normalizeFactor;
+
+   for (i = first; i < count; i++) {
+      x = srcQuat->x[i]; y = srcQuat->y[i]; z = srcQuat->z[i]; w = srcQuat->w[i];
+      normalizeFactor = 1.0 / sqrt(x*x + y*y + z*z + w*w);
+      destQuat->x[i] = x * normalizeFactor;
+      destQuat->y[i] = y * normalizeFactor;
+      destQuat->z[i] = z * normalizeFactor;
+      destQuat->w[i] = w * normalizeFactor;
+   }
+}
+
+/* Fills in a column matrix from the nine distinct terms that
+ * q_to_col_matrix() computes.
+ */
+static void q_batch_fill_col_matrix(q_matrix_type destMatrix,
+                                    double xx, double yy, double zz,
+                                    double xy, double xz, double yz,
+                                    double wx, double wy, double wz)
+{
+   destMatrix[Q_X][Q_X] = 1.0 - (yy + zz);
+   destMatrix[Q_X][Q_Y] = xy - wz;
+   destMatrix[Q_X][Q_Z] = xz + wy;
+   destMatrix[Q_X][Q_W] = 0.0;
+
+   destMatrix[Q_Y][Q_X] = xy + wz;
+   destMatrix[Q_Y][Q_Y] = 1.0 - (xx + zz);
+   destMatrix[Q_Y][Q_Z] = yz - wx;
+   destMatrix[Q_Y][Q_W] = 0.0;
+
+   destMatrix[Q_Z][Q_X] = xz - wy;
+   destMatrix[Q_Z][Q_Y] = yz + wx;
+   destMatrix[Q_Z][Q_Z] = 1.0 - (xx + yy);
+   destMatrix[Q_Z][Q_W] = 0.0;
+
+   destMatrix[Q_W][Q_X] = 0.0;
+   destMatrix[Q_W][Q_Y] = 0.0;
+   destMatrix[Q_W][Q_Z] = 0.0;
+   destMatrix[Q_W][Q_W] = 1.0;
+}
+
+static void q_batch_to_col_matrix_scalar(q_matrix_type *destMatrices,
+                                         const q_batch_type *srcQuat,
+                                         int first, int count)
+{
+   int i;
+   double x, y, z, w, s, xs, ys, zs;
+
+   for (i = first; i < count; i++) {
+      x = srcQuat->x[i]; y = srcQuat->y[i]; z = srcQuat->z[i]; w = srcQuat->w[i];
+      s = 2.0 / (x*x + y*y + z*z + w*w);
+      xs = x * s;  ys = y * s;  zs = z * s;
+      q_batch_fill_col_matrix(destMatrices[i],
+                              x * xs, y * ys, z * zs,
+                              x * ys, x * zs, y * zs,
+                              w * xs, w * ys, w * zs);
+   }
+}
+
+
+/*****************************************************************************
+ *
+    SSE2 versions, two at a time.  Each returns how many it did.
+ *
+ *****************************************************************************/
+
+#ifdef Q_BATCH_HAVE_SSE2
+
+static int q_batch_mult_sse2(const q_batch_type *dest,
+                             const q_batch_type *qLeft,
+                             const q_batch_type *qRight, int count)
+{
+   int i;
+   __m128d lx, ly, lz, lw, rx, ry, rz, rw;
+
+   for (i = 0; i + 2 <= count; i += 2) {
+      lx = _mm_loadu_pd(qLeft->x + i);  ly = _mm_loadu_pd(qLeft->y + i);
+      lz = _mm_loadu_pd(qLeft->z + i);  lw = _mm_loadu_pd(qLeft->w + i);
+      rx = _mm_loadu_pd(qRight->x + i); ry = _mm_loadu_pd(qRight->y + i);
+      rz = _mm_loadu_pd(qRight->z + i); rw = _mm_loadu_pd(qRight->w + i);
+      _mm_storeu_pd(dest->w + i,
+         _mm_sub_pd(_mm_sub_pd(_mm_sub_pd(_mm_mul_pd(lw, rw), _mm_mul_pd(lx, rx)),
+                               _mm_mul_pd(ly, ry)), _mm_mul_pd(lz, rz)));
+      _mm_storeu_pd(dest->x + i,
+         _mm_sub_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(lw, rx), _mm_mul_pd(lx, rw)),
+                               _mm_mul_pd(ly, rz)), _mm_mul_pd(lz, ry)));
+      _mm_storeu_pd(dest->y + i,
+         _mm_sub_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(lw, ry), _mm_mul_pd(ly, rw)),
+                               _mm_mul_pd(lz, rx)), _mm_mul_pd(lx, rz)));
+      _mm_storeu_pd(dest->z + i,
+         _mm_sub_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(lw, rz), _mm_mul_pd(lz, rw)),
+                               _mm_mul_pd(lx, ry)), _mm_mul_pd(ly, rx)));
+   }
+   return i;
+}
+
+static int q_batch_xform_sse2(const q_vec_batch_type *destVec,
+                              const q_batch_type *q,
+                              const q_vec_batch_type *vec, int count)
+{
+   int i;
+   __m128d qx, qy, qz, qw, vx, vy, vz, uu, uv, scale, a, b, c;
+   const __m128d one = _mm_set1_pd(1.0);
+   const __m128d two = _mm_set1_pd(2.0);
+
+   for (i = 0; i + 2 <= count; i += 2) {
+      qx = _mm_loadu_pd(q->x + i); qy = _mm_loadu_pd(q->y + i);
+      qz = _mm_loadu_pd(q->z + i); qw = _mm_loadu_pd(q->w + i);
+      vx = _mm_loadu_pd(vec->x + i); vy = _mm_loadu_pd(vec->y + i);
+      vz = _mm_loadu_pd(vec->z + i);
+      uu = _mm_add_pd(_mm_add_pd(_mm_mul_pd(qx, qx), _mm_mul_pd(qy, qy)),
+                      _mm_mul_pd(qz, qz));
+      uv = _mm_add_pd(_mm_add_pd(_mm_mul_pd(qx, vx), _mm_mul_pd(qy, vy)),
+                      _mm_mul_pd(qz, vz));
+      scale = _mm_div_pd(one, _mm_add_pd(_mm_mul_pd(qw, qw), uu));
+      a = _mm_mul_pd(_mm_sub_pd(_mm_mul_pd(qw, qw), uu), scale);
+      b = _mm_mul_pd(_mm_mul_pd(two, uv), scale);
+      c = _mm_mul_pd(_mm_mul_pd(two, qw), scale);
+      _mm_storeu_pd(destVec->x + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(a, vx),
+         _mm_mul_pd(b, qx)),
+         _mm_mul_pd(c, _mm_sub_pd(_mm_mul_pd(qy, vz), _mm_mul_pd(qz, vy)))));
+      _mm_storeu_pd(destVec->y + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(a, vy),
+         _mm_mul_pd(b, qy)),
+         _mm_mul_pd(c, _mm_sub_pd(_mm_mul_pd(qz, vx), _mm_mul_pd(qx, vz)))));
+      _mm_storeu_pd(destVec->z + i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(a, vz),
+         _mm_mul_pd(b, qz)),
+         _mm_mul_pd(c, _mm_sub_pd(_mm_mul_pd(qx, vy), _mm_mul_pd(qy, vx)))));
+   }
+   return i;
+}
+
+/* The dot products and blends are done two at a time; the scales need
+ * acos() and sin(), so are worked out one at a time.
+ */
+static int q_batch_slerp_sse2(const q_batch_type *destQuat,
+                              const q_batch_type *startQuat,
+                              const q_batch_type *endQuat,
+                              const double *t, int count)
+{
+   int i, j;
+   __m128d sx, sy, sz, sw, ex, ey, ez, ew, cosOmega, s0, s1;
+   double cosOmegas[2], startScales[2], endScales[2];
+
+   for (i = 0; i + 2 <= count; i += 2) {
+      sx = _mm_loadu_pd(startQuat->x + i); sy = _mm_loadu_pd(startQuat->y + i);
+      sz = _mm_loadu_pd(startQuat->z + i); sw = _mm_loadu_pd(startQuat->w + i);
+      ex = _mm_loadu_pd(endQuat->x + i);   ey = _mm_loadu_pd(endQuat->y + i);
+      ez = _mm_loadu_pd(endQuat->z + i);   ew = _mm_loadu_pd(endQuat->w + i);
+      cosOmega = _mm_add_pd(_mm_add_pd(_mm_mul_pd(sx, ex), _mm_mul_pd(sy, ey)),
+                            _mm_add_pd(_mm_mul_pd(sz, ez), _mm_mul_pd(sw, ew)));
+      _mm_storeu_pd(cosOmegas, cosOmega);
+      for (j = 0; j < 2; j++) {
+         q_batch_slerp_scales(&startScales[j], &endScales[j],
+                              fabs(cosOmegas[j]), t[i + j]);
+         if (cosOmegas[j] < 0.0) {
+            startScales[j] = -startScales[j];
+         }
+      }
+      s0 = _mm_loadu_pd(startScales);
+      s1 = _mm_loadu_pd(endScales);
+      _mm_storeu_pd(destQuat->x + i, _mm_add_pd(_mm_mul_pd(s0, sx), _mm_mul_pd(s1, ex)));
+      _mm_storeu_pd(destQuat->y + i, _mm_add_pd(_mm_mul_pd(s0, sy), _mm_mul_pd(s1, ey)));
+      _mm_storeu_pd(destQuat->z + i, _mm_add_pd(_mm_mul_pd(s0, sz), _mm_mul_pd(s1, ez)));
+      _mm_storeu_pd(destQuat->w + i, _mm_add_pd(_mm_mul_pd(s0, sw), _mm_mul_pd(s1, ew)));
+   }
+   return i;
+}
+
+static int q_batch_normalize_sse2(const q_batch_type *destQuat,
+                                  const q_batch_type *srcQuat, int count)
+{
+   int i;
+   __m128d x, y, z, w, normalizeFactor;
+   const __m128d one = _mm_set1_pd(1.0);
+
+   for (i = 0; i + 2 <= count; i += 2) {
+      x = _mm_loadu_pd(srcQuat->x + i); y = _mm_loadu_pd(srcQuat->y + i);
+      z = _mm_loadu_pd(srcQuat->z + i); w = _mm_loadu_pd(srcQuat->w + i);
+      normalizeFactor = _mm_div_pd(one, _mm_sqrt_pd(
+         _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)),
+                    _mm_add_pd(_mm_mul_pd(z, z), _mm_mul_pd(w, w)))));
+      _mm_storeu_pd(destQuat->x + i, _mm_mul_pd(x, normalizeFactor));
+      _mm_storeu_pd(destQuat->y + i, _mm_mul_pd(y, normalizeFactor));
+      _mm_storeu_pd(destQuat->z + i, _mm_mul_pd(z, normalizeFactor));
+      _mm_storeu_pd(destQuat->w + i, _mm_mul_pd(w, normalizeFactor));
+   }
+   return i;
+}
+
+/* The terms are worked out two at a time, then spread out into the
+ * matrices one at a time.
+ */
+static int q_batch_to_col_matrix_sse2(q_matrix_type *destMatrices,
+                                      const q_batch_type *srcQuat, int count)
+{
+   int i, j;
+   __m128d x, y, z, w, s, xs, ys, zs;
+   double terms[9][2];
+   const __m128d two = _mm_set1_pd(2.0);
+
+   for (i = 0; i + 2 <= count; i += 2) {
+      x = _mm_loadu_pd(srcQuat->x + i); y = _mm_loadu_pd(srcQuat->y + i);
+      z = _mm_loadu_pd(srcQuat->z + i); w = _mm_loadu_pd(srcQuat->w + i);
+      s = _mm_div_pd(two,
+         _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)),
+                    _mm_add_pd(_mm_mul_pd(z, z), _mm_mul_pd(w, w))));
+      xs = _mm_mul_pd(x, s); ys = _mm_mul_pd(y, s); zs = _mm_mul_pd(z, s);
+      _mm_storeu_pd(terms[0], _mm_mul_pd(x, xs));
+      _mm_storeu_pd(terms[1], _mm_mul_pd(y, ys));
+      _mm_storeu_pd(terms[2], _mm_mul_pd(z, zs));
+      _mm_storeu_pd(terms[3], _mm_mul_pd(x, ys));
+      _mm_storeu_pd(terms[4], _mm_mul_pd(x, zs));
+      _mm_storeu_pd(terms[5], _mm_mul_pd(y, zs));
+      _mm_storeu_pd(terms[6], _mm_mul_pd(w, xs));
+      _mm_storeu_pd(terms[7], _mm_mul_pd(w, ys));
+      _mm_storeu_pd(terms[8], _mm_mul_pd(w, zs));
+      for (j = 0; j < 2; j++) {
+         q_batch_fill_col_matrix(destMatrices[i + j],
+                                 terms[0][j], terms[1][j], terms[2][j],
+                                 terms[3][j], terms[4][j], terms[5][j],
+                                 terms[6][j], terms[7][j], terms[8][j]);
+      }
+   }
+   return i;
+}
+
+#endif /* Q_BATCH_HAVE_SSE2 */
+
+
+/*****************************************************************************
+ *
+    AVX versions, four at a time.  Each returns how many it did.
+ *
+ *****************************************************************************/
+
+#ifdef Q_BATCH_HAVE_AVX
+
+Q_BATCH_AVX_FUNCTION
+static int q_batch_mult_avx(const q_batch_type *dest,
+                            const q_batch_type *qLeft,
+                            const q_batch_type *qRight, int count)
+{
+   int i;
+   __m256d lx, ly, lz, lw, rx, ry, rz, rw;
+
+   for (i = 0; i + 4 <= count; i += 4) {
+      lx = _mm256_loadu_pd(qLeft->x + i);  ly = _mm256_loadu_pd(qLeft->y + i);
+      lz = _mm256_loadu_pd(qLeft->z + i);  lw = _mm256_loadu_pd(qLeft->w + i);
+      rx = _mm256_loadu_pd(qRight->x + i); ry = _mm256_loadu_pd(qRight->y + i);
+      rz = _mm256_loadu_pd(qRight->z + i); rw = _mm256_loadu_pd(qRight->w + i);
+      _mm256_storeu_pd(dest->w + i,
+         _mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(_mm256_mul_pd(lw, rw),
+            _mm256_mul_pd(lx, rx)), _mm256_mul_pd(ly, ry)), _mm256_mul_pd(lz, rz)));
+      _mm256_storeu_pd(dest->x + i,
+         _mm256_sub_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(lw, rx),
+            _mm256_mul_pd(lx, rw)), _mm256_mul_pd(ly, rz)), _mm256_mul_pd(lz, ry)));
+      _mm256_storeu_pd(dest->y + i,
+         _mm256_sub_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(lw, ry),
+            _mm256_mul_pd(ly, rw)), _mm256_mul_pd(lz, rx)), _mm256_mul_pd(lx, rz)));
+      _mm256_storeu_pd(dest->z + i,
+         _mm256_sub_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(lw, rz),
+            _mm256_mul_pd(lz, rw)), _mm256_mul_pd(lx, ry)), _mm256_mul_pd(ly, rx)));
+   }
+   return i;
+}
+
+Q_BATCH_AVX_FUNCTION
+static int q_batch_xform_avx(const q_vec_batch_type *destVec,
+                             const q_batch_type *q,
+                             const q_vec_batch_type *vec, int count)
+{
+   int i;
+   __m256d qx, qy, qz, qw, vx, vy, vz, uu, uv, scale, a, b, c;
+   const __m256d one = _mm256_set1_pd(1.0);
+   const __m256d two = _mm256_set1_pd(2.0);
+
+   for (i = 0; i + 4 <= count; i += 4) {
+      qx = _mm256_loadu_pd(q->x + i); qy = _mm256_loadu_pd(q->y + i);
+      qz = _mm256_loadu_pd(q->z + i); qw = _mm256_loadu_pd(q->w + i);
+      vx = _mm256_loadu_pd(vec->x + i); vy = _mm256_loadu_pd(vec->y + i);
+      vz = _mm256_loadu_pd(vec->z + i);
+      uu = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(qx, qx),
+                                       _mm256_mul_pd(qy, qy)),
+                         _mm256_mul_pd(qz, qz));
+      uv = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(qx, vx),
+                                       _mm256_mul_pd(qy, vy)),
+                         _mm256_mul_pd(qz, vz));
+      scale = _mm256_div_pd(one, _mm256_add_pd(_mm256_mul_pd(qw, qw), uu));
+      a = _mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(qw, qw), uu), scale);
+      b = _mm256_mul_pd(_mm256_mul_pd(two, uv), scale);
+      c = _mm256_mul_pd(_mm256_mul_pd(two, qw), scale);
+      _mm256_storeu_pd(destVec->x + i, _mm256_add_pd(_mm256_add_pd(
+         _mm256_mul_pd(a, vx), _mm256_mul_pd(b, qx)), _mm256_mul_pd(c,
+         _mm256_sub_pd(_mm256_mul_pd(qy, vz), _mm256_mul_pd(qz, vy)))));
+      _mm256_storeu_pd(destVec->y + i, _mm256_add_pd(_mm256_add_pd(
+         _mm256_mul_pd(a, vy), _mm256_mul_pd(b, qy)), _mm256_mul_pd(c,
+         _mm256_sub_pd(_mm256_mul_pd(qz, vx), _mm256_mul_pd(qx, vz)))));
+      _mm256_storeu_pd(destVec->z + i, _mm256_add_pd(_mm256_add_pd(
+         _mm256_mul_pd(a, vz), _mm256_mul_pd(b, qz)), _mm256_mul_pd(c,
+         _mm256_sub_pd(_mm256_mul_pd(qx, vy), _mm256_mul_pd(qy, vx)))));
+   }
+   return i;
+}
+
+Q_BATCH_AVX_FUNCTION
+static int q_batch_slerp_avx(const q_batch_type *destQuat,
+                             const q_batch_type *startQuat,
+                             const q_batch_type *endQuat,
+                             const double *t, int count)
+{
+   int i, j;
+   __m256d sx, sy, sz, sw, ex, ey, ez, ew, cosOmega, s0, s1;
+   double cosOmegas[4], startScales[4], endScales[4];
+
+   for (i = 0; i + 4 <= count; i += 4) {
+      sx = _mm256_loadu_pd(startQuat->x + i); sy = _mm256_loadu_pd(startQuat->y + i);
+      sz = _mm256_loadu_pd(startQuat->z + i); sw = _mm256_loadu_pd(startQuat->w + i);
+      ex = _mm256_loadu_pd(endQuat->x + i);   ey = _mm256_loadu_pd(endQuat->y + i);
+      ez = _mm256_loadu_pd(endQuat->z + i);   ew = _mm256_loadu_pd(endQuat->w + i);
+      cosOmega = _mm256_add_pd(
+         _mm256_add_pd(_mm256_mul_pd(sx, ex), _mm256_mul_pd(sy, ey)),
+         _mm256_add_pd(_mm256_mul_pd(sz, ez), _mm256_mul_pd(sw, ew)));
+      _mm256_storeu_pd(cosOmegas, cosOmega);
+      for (j = 0; j < 4; j++) {
+         q_batch_slerp_scales(&startScales[j], &endScales[j],
+                              fabs(cosOmegas[j]), t[i + j]);
+         if (cosOmegas[j] < 0.0) {
+            startScales[j] = -startScales[j];
+         }
+      }
+      s0 = _mm256_loadu_pd(startScales);
+      s1 = _mm256_loadu_pd(endScales);
+      _mm256_storeu_pd(destQuat->x + i,
+         _mm256_add_pd(_mm256_mul_pd(s0, sx), _mm256_mul_pd(s1, ex)));
+      _mm256_storeu_pd(destQuat->y + i,
+         _mm256_add_pd(_mm256_mul_pd(s0, sy), _mm256_mul_pd(s1, ey)));
+      _mm256_storeu_pd(destQuat->z + i,
+         _mm256_add_pd(_mm256_mul_pd(s0, sz), _mm256_mul_pd(s1, ez)));
+      _mm256_storeu_pd(destQuat->w + i,
+         _mm256_add_pd(_mm256_mul_pd(s0, sw), _mm256_mul_pd(s1, ew)));
+   }
+   return i;
+}
+
+Q_BATCH_AVX_FUNCTION
+static int q_batch_normalize_avx(const q_batch_type *destQuat,
+                                 const q_batch_type *srcQuat, int count)
+{
+   int i;
+   __m256d x, y, z, w, normalizeFactor;
+   const __m256d one = _mm256_set1_pd(1.0);
+
+   for (i = 0; i + 4 <= count; i += 4) {
+      x = _mm256_loadu_pd(srcQuat->x + i); y = _mm256_loadu_pd(srcQuat->y + i);
+      z = _mm256_loadu_pd(srcQuat->z + i); w = _mm256_loadu_pd(srcQuat->w + i);
+      normalizeFactor = _mm256_div_pd(one, _mm256_sqrt_pd(_mm256_add_pd(
+         _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)),
+         _mm256_add_pd(_mm256_mul_pd(z, z), _mm256_mul_pd(w, w)))));
+      _mm256_storeu_pd(destQuat->x + i, _mm256_mul_pd(x, normalizeFactor));
+      _mm256_storeu_pd(destQuat->y + i, _mm256_mul_pd(y, normalizeFactor));
+      _mm256_storeu_pd(destQuat->z + i, _mm256_mul_pd(z, normalizeFactor));
+      _mm256_storeu_pd(destQuat->w + i, _mm256_mul_pd(w, normalizeFactor));
+   }
+   return i;
+}
+
+Q_BATCH_AVX_FUNCTION
+static int q_batch_to_col_matrix_avx(q_matrix_type *destMatrices,
+                                     const q_batch_type *srcQuat, int count)
+{
+   int i, j;
+   __m256d x, y, z, w, s, xs, ys, zs;
+   double terms[9][4];
+   const __m256d two = _mm256_set1_pd(2.0);
+
+   for (i = 0; i + 4 <= count; i += 4) {
+      x = _mm256_loadu_pd(srcQuat->x + i); y = _mm256_loadu_pd(srcQuat->y + i);
+      z = _mm256_loadu_pd(srcQuat->z + i); w = _mm256_loadu_pd(srcQuat->w + i);
+      s = _mm256_div_pd(two, _mm256_add_pd(
+         _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)),
+         _mm256_add_pd(_mm256_mul_pd(z, z), _mm256_mul_pd(w, w))));
+      xs = _mm256_mul_pd(x, s); ys = _mm256_mul_pd(y, s); zs = _mm256_mul_pd(z, s);
+      _mm256_storeu_pd(terms[0], _mm256_mul_pd(x, xs));
+      _mm256_storeu_pd(terms[1], _mm256_mul_pd(y, ys));
+      _mm256_storeu_pd(terms[2], _mm256_mul_pd(z, zs));
+      _mm256_storeu_pd(terms[3], _mm256_mul_pd(x, ys));
+      _mm256_storeu_pd(terms[4], _mm256_mul_pd(x, zs));
+      _mm256_storeu_pd(terms[5], _mm256_mul_pd(y, zs));
+      _mm256_storeu_pd(terms[6], _mm256_mul_pd(w, xs));
+      _mm256_storeu_pd(terms[7], _mm256_mul_pd(w, ys));
+      _mm256_storeu_pd(terms[8], _mm256_mul_pd(w, zs));
+      for (j = 0; j < 4; j++) {
+         q_batch_fill_col_matrix(destMatrices[i + j],
+                                 terms[0][j], terms[1][j], terms[2][j],
+                                 terms[3][j], terms[4][j], terms[5][j],
+                                 terms[6][j], terms[7][j], terms[8][j]);
+      }
+   }
+   return i;
+}
+
+#endif /* Q_BATCH_HAVE_AVX */
+
+
+/*****************************************************************************
+ *
+    the routines themselves
+ *
+ *****************************************************************************/
+
+void q_batch_mult(const q_batch_type *destQuat, const q_batch_type *qLeft,
+                  const q_batch_type *qRight, int count)
+{
+   int done = 0;
+
+   switch (q_batch_current_level()) {
+#ifdef Q_BATCH_HAVE_AVX
+      case Q_BATCH_AVX:
+         done = q_batch_mult_avx(destQuat, qLeft, qRight, count);
+         break;
+#endif
+#ifdef Q_BATCH_HAVE_SSE2
+      case Q_BATCH_SSE2:
+         done = q_batch_mult_sse2(destQuat, qLeft, qRight, count);
+         break;
+#endif
+      default:
+         break;
+   }
+   q_batch_mult_scalar(destQuat, qLeft, qRight, done, count);
+
+}   /* q_batch_mult */
+
+
+void q_batch_xform(const q_vec_batch_type *destVec, const q_batch_type *q,
+                   const q_vec_batch_type *vec, int count)
+{
+   int done = 0;
+
+   switch (q_batch_current_level()) {
+#ifdef Q_BATCH_HAVE_AVX
+      case Q_BATCH_AVX:
+         done = q_batch_xform_avx(destVec, q, vec, count);
+         break;
+#endif
+#ifdef Q_BATCH_HAVE_SSE2
+      case Q_BATCH_SSE2:
+         done = q_batch_xform_sse2(destVec, q, vec, count);
+         break;
+#endif
+      default:
+         break;
+   }
+   q_batch_xform_scalar(destVec, q, vec, done, count);
+
+}   /* q_batch_xform */
+
+
+void q_batch_slerp(const q_batch_type *destQuat, const q_batch_type *startQuat,
+                   const q_batch_type *endQuat, const double *t, int count)
+{
+   int done = 0;
+
+   switch (q_batch_current_level()) {
+#ifdef Q_BATCH_HAVE_AVX
+      case Q_BATCH_AVX:
+         done = q_batch_slerp_avx(destQuat, startQuat, endQuat, t, count);
+         break;
+#endif
+#ifdef Q_BATCH_HAVE_SSE2
+      case Q_BATCH_SSE2:
+         done = q_batch_slerp_sse2(destQuat, startQuat, endQuat, t, count);
+         break;
+#endif
+      default:
+         break;
+   }
+   q_batch_slerp_scalar(destQuat, startQuat, endQuat, t, done, count);
+
+}   /* q_batch_slerp */
+
+
+void q_batch_normalize(const q_batch_type *destQuat,
+                       const q_batch_type *srcQuat, int count)
+{
+   int done = 0;
+
+   switch (q_batch_current_level()) {
+#ifdef Q_BATCH_HAVE_AVX
+      case Q_BATCH_AVX:
+         done = q_batch_normalize_avx(destQuat, srcQuat, count);
+         break;
+#endif
+#ifdef Q_BATCH_HAVE_SSE2
+      case Q_BATCH_SSE2:
+         done = q_batch_normalize_sse2(destQuat, srcQuat, count);
+         break;
+#endif
+      default:
+         break;
+   }
+   q_batch_normalize_scalar(destQuat, srcQuat, done, count);
+
+}   /* q_batch_normalize */
+
+
+void q_batch_to_col_matrix(q_matrix_type *destMatrices,
+                           const q_batch_type *srcQuat, int count)
+{
+   int done = 0;
+
+   switch (q_batch_current_level()) {
+#ifdef Q_BATCH_HAVE_AVX
+      case Q_BATCH_AVX:
+         done = q_batch_to_col_matrix_avx(destMatrices, srcQuat, count);
+         break;
+#endif
+#ifdef Q_BATCH_HAVE_SSE2
+      case Q_BATCH_SSE2:
+         done = q_batch_to_col_matrix_sse2(destMatrices, srcQuat, count);
+         break;
+#endif
+      default:
+         break;
+   }
+   q_batch_to_col_matrix_scalar(destMatrices, srcQuat, done, count);
+
+}   /* q_batch_to_col_matrix */
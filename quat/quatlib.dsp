@@ -94,6 +94,10 @@ SOURCE=quat.h
 # End Source File
 # Begin Source File
 
+SOURCE=quatbatch.c
+# End Source File
+# Begin Source File
+
 SOURCE=vector.c
 # End Source File
 # Begin Source File
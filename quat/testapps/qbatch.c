@@ -0,0 +1,244 @@
+/*****************************************************************************
+ *
+    qbatch.c - times the q_batch routines against calling the one-at-a-time
+    	    	routines in a loop, at each instruction set the CPU has, and
+    	    	checks that they all get the same answers.
+
+	Usage:  quat_qbatch [-n count] [-c cycles]
+
+	    - count is how many quaternions in a batch (default 256, about
+	      what a large motion-capture frame has)
+	    - cycles is how many times to do each batch (default 20000)
+
+	Prints one line per routine and instruction set, with the time per
+	quaternion and the largest difference from the one-at-a-time answer.
+ *
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "quat.h"
+
+enum { OP_MULT, OP_XFORM, OP_SLERP, OP_NORMALIZE, OP_TO_COL_MATRIX, NUM_OPS };
+static const char *opNames[NUM_OPS] =
+   { "mult", "xform", "slerp", "normalize", "to_col_matrix" };
+static const char *levelNames[] = { "scalar", "sse2", "avx" };
+
+/* the same inputs held both ways, and room for the outputs */
+static int count;
+static q_type *aQuats, *bQuats, *outQuats;
+static q_vec_type *vecs, *outVecs;
+static q_matrix_type *outMatrices, *batchMatrices;
+static double *t;
+static double *soa;
+static q_batch_type aBatch, bBatch, outBatch;
+static q_vec_batch_type vecBatch, outVecBatch;
+
+static double random_unit(void)
+{
+   return 2.0 * rand() / (double)RAND_MAX - 1.0;
+}
+
+static void *allocate(size_t size)
+{
+   void *p = malloc(size);
+   if (p == NULL) {
+      fprintf(stderr, "qbatch: Out of memory\n");
+      exit(-1);
+   }
+   return p;
+}
+
+static void setup(void)
+{
+   int i;
+   double *next;
+
+   aQuats = allocate(count * sizeof(q_type));
+   bQuats = allocate(count * sizeof(q_type));
+   outQuats = allocate(count * sizeof(q_type));
+   vecs = allocate(count * sizeof(q_vec_type));
+   outVecs = allocate(count * sizeof(q_vec_type));
+   outMatrices = allocate(count * sizeof(q_matrix_type));
+   batchMatrices = allocate(count * sizeof(q_matrix_type));
+   t = allocate(count * sizeof(double));
+   next = soa = allocate(18 * count * sizeof(double));
+   aBatch.x = next; next += count;  aBatch.y = next; next += count;
+   aBatch.z = next; next += count;  aBatch.w = next; next += count;
+   bBatch.x = next; next += count;  bBatch.y = next; next += count;
+   bBatch.z = next; next += count;  bBatch.w = next; next += count;
+   outBatch.x = next; next += count;  outBatch.y = next; next += count;
+   outBatch.z = next; next += count;  outBatch.w = next; next += count;
+   vecBatch.x = next; next += count;  vecBatch.y = next; next += count;
+   vecBatch.z = next; next += count;
+   outVecBatch.x = next; next += count;  outVecBatch.y = next; next += count;
+   outVecBatch.z = next;
+
+   for (i = 0; i < count; i++) {
+      q_make(aQuats[i], random_unit(), random_unit(), random_unit(),
+             Q_PI * random_unit());
+      q_make(bQuats[i], random_unit(), random_unit(), random_unit(),
+             Q_PI * random_unit());
+      q_vec_set(vecs[i], random_unit(), random_unit(), random_unit());
+      t[i] = 0.5 * (random_unit() + 1.0);
+      aBatch.x[i] = aQuats[i][Q_X];  aBatch.y[i] = aQuats[i][Q_Y];
+      aBatch.z[i] = aQuats[i][Q_Z];  aBatch.w[i] = aQuats[i][Q_W];
+      bBatch.x[i] = bQuats[i][Q_X];  bBatch.y[i] = bQuats[i][Q_Y];
+      bBatch.z[i] = bQuats[i][Q_Z];  bBatch.w[i] = bQuats[i][Q_W];
+      vecBatch.x[i] = vecs[i][Q_X];  vecBatch.y[i] = vecs[i][Q_Y];
+      vecBatch.z[i] = vecs[i][Q_Z];
+   }
+}
+
+/* one batch the old way */
+static void run_scalar(int op)
+{
+   int i;
+
+   switch (op) {
+      case OP_MULT:
+         for (i = 0; i < count; i++) q_mult(outQuats[i], aQuats[i], bQuats[i]);
+         break;
+      case OP_XFORM:
+         for (i = 0; i < count; i++) q_xform(outVecs[i], aQuats[i], vecs[i]);
+         break;
+      case OP_SLERP:
+         for (i = 0; i < count; i++) q_slerp(outQuats[i], aQuats[i], bQuats[i], t[i]);
+         break;
+      case OP_NORMALIZE:
+         for (i = 0; i < count; i++) q_normalize(outQuats[i], aQuats[i]);
+         break;
+      case OP_TO_COL_MATRIX:
+         for (i = 0; i < count; i++) q_to_col_matrix(outMatrices[i], aQuats[i]);
+         break;
+   }
+}
+
+/* one batch with the batch routine */
+static void run_batch(int op)
+{
+   switch (op) {
+      case OP_MULT:
+         q_batch_mult(&outBatch, &aBatch, &bBatch, count);
+         break;
+      case OP_XFORM:
+         q_batch_xform(&outVecBatch, &aBatch, &vecBatch, count);
+         break;
+      case OP_SLERP:
+         q_batch_slerp(&outBatch, &aBatch, &bBatch, t, count);
+         break;
+      case OP_NORMALIZE:
+         q_batch_normalize(&outBatch, &aBatch, count);
+         break;
+      case OP_TO_COL_MATRIX:
+         q_batch_to_col_matrix(batchMatrices, &aBatch, count);
+         break;
+   }
+}
+
+/* largest difference between the batch and one-at-a-time answers */
+static double difference(int op)
+{
+   int i, j, k;
+   double diff = 0;
+
+   for (i = 0; i < count; i++) {
+      switch (op) {
+         case OP_XFORM:
+            diff = Q_MAX(diff, fabs(outVecBatch.x[i] - outVecs[i][Q_X]));
+            diff = Q_MAX(diff, fabs(outVecBatch.y[i] - outVecs[i][Q_Y]));
+            diff = Q_MAX(diff, fabs(outVecBatch.z[i] - outVecs[i][Q_Z]));
+            break;
+         case OP_TO_COL_MATRIX:
+            for (j = 0; j < 4; j++) {
+               for (k = 0; k < 4; k++) {
+                  diff = Q_MAX(diff, fabs(batchMatrices[i][j][k] -
+                                          outMatrices[i][j][k]));
+               }
+            }
+            break;
+         default:
+            diff = Q_MAX(diff, fabs(outBatch.x[i] - outQuats[i][Q_X]));
+            diff = Q_MAX(diff, fabs(outBatch.y[i] - outQuats[i][Q_Y]));
+            diff = Q_MAX(diff, fabs(outBatch.z[i] - outQuats[i][Q_Z]));
+            diff = Q_MAX(diff, fabs(outBatch.w[i] - outQuats[i][Q_W]));
+            break;
+      }
+   }
+   return diff;
+}
+
+/* nanoseconds per quaternion for cycles batches */
+static double time_per_quat(int op, int batch, int cycles)
+{
+   int c;
+   clock_t start = clock();
+
+   for (c = 0; c < cycles; c++) {
+      if (batch) {
+         run_batch(op);
+      } else {
+         run_scalar(op);
+      }
+   }
+   return 1e9 * (double)(clock() - start) / CLOCKS_PER_SEC /
+      ((double)cycles * count);
+}
+
+int main(int argc, char *argv[])
+{
+   int i, op, level, best;
+   int cycles = 20000;
+   double scalarTime, batchTime;
+
+   count = 256;
+   for (i = 1; i < argc; i++) {
+      if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+         count = atoi(argv[++i]);
+      } else if (!strcmp(argv[i], "-c") && (i + 1 < argc)) {
+         cycles = atoi(argv[++i]);
+      } else {
+         fprintf(stderr, "Usage: %s [-n count] [-c cycles]\n", argv[0]);
+         return -1;
+      }
+   }
+   if ((count <= 0) || (cycles <= 0)) {
+      fprintf(stderr, "qbatch: count and cycles must be positive\n");
+      return -1;
+   }
+   setup();
+
+   best = q_batch_simd_level();
+   printf("%d quaternions per batch, %d batches; best level is %s\n",
+          count, cycles, levelNames[best]);
+   printf("%-14s %-7s %12s %12s %8s %10s\n", "routine", "level",
+          "loop ns/q", "batch ns/q", "speedup", "max diff");
+   for (op = 0; op < NUM_OPS; op++) {
+      scalarTime = time_per_quat(op, 0, cycles);
+      for (level = Q_BATCH_SCALAR; level <= best; level++) {
+         q_batch_set_simd_level(level);
+         batchTime = time_per_quat(op, 1, cycles);
+         run_scalar(op);
+         run_batch(op);
+         printf("%-14s %-7s %12.2f %12.2f %8.2f %10.3g\n", opNames[op],
+                levelNames[level], scalarTime, batchTime,
+                batchTime > 0 ? scalarTime / batchTime : 0.0,
+                difference(op));
+      }
+      q_batch_set_simd_level(best);
+   }
+
+   free(soa);
+   free(t);
+   free(batchMatrices);
+   free(outMatrices);
+   free(outVecs);
+   free(vecs);
+   free(outQuats);
+   free(bQuats);
+   free(aQuats);
+   return 0;
+}
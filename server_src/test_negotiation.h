@@ -0,0 +1,115 @@
+// test_negotiation.h
+//
+// What test_analog_compact, test_button_changes and test_tracker_frame
+// share.  Each checks a kind of message that a server sends only while
+// every client connected has asked for it.  A device and its remote talk
+// over a loopback connection; then an older client connects, which is a
+// bare connection that never asks and decodes reports the way remotes
+// always have, and the server must fall back to what that client can read
+// until it leaves.  Each test includes this once, registers its own
+// handlers and makes its own checks.
+
+#ifndef TEST_NEGOTIATION_H
+#define TEST_NEGOTIATION_H
+
+#include <stdio.h> // for printf, fprintf, snprintf, stderr, NULL
+
+#include "vrpn_BaseClass.h"  // for vrpn_BaseClass
+#include "vrpn_Connection.h" // for vrpn_Connection, etc
+#include "vrpn_Shared.h"     // for vrpn_SleepMsecs
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// The server with its device, the remote that asks for the new messages,
+// and the older client while it is connected.
+static vrpn_Connection *server = NULL;
+static vrpn_BaseClass *serverDevice = NULL;
+static vrpn_BaseClass *remoteDevice = NULL;
+static vrpn_Connection *oldConnection = NULL;
+
+static void run(int msecs)
+{
+    for (int i = 0; i < msecs; i++) {
+        serverDevice->mainloop();
+        server->mainloop();
+        remoteDevice->mainloop();
+        if (oldConnection) {
+            oldConnection->mainloop();
+        }
+        vrpn_SleepMsecs(1);
+    }
+}
+
+// Runs until the remote's count reaches want, and the old client's (if it
+// is connected) reaches oldWant, or for a second if they never do.
+static void run_until(const int &count, int want, const int &oldCount,
+                      int oldWant)
+{
+    for (int i = 0; i < 1000; i++) {
+        if ((count >= want) && (!oldConnection || (oldCount >= oldWant))) {
+            return;
+        }
+        run(1);
+    }
+}
+
+// Starts the device on server and waits for remote to connect to it.
+static void start(vrpn_BaseClass *device, vrpn_BaseClass *remote)
+{
+    serverDevice = device;
+    remoteDevice = remote;
+    run(500);
+    check(remote->connectionPtr()->connected() != 0, "new client connected");
+}
+
+// Opens the older client's connection to the server on port, which the
+// caller registers its handlers on before connect_old_client().
+static vrpn_Connection *open_old_client(int port)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "localhost:%d", port);
+    oldConnection = vrpn_get_connection_by_name(name, NULL, NULL, NULL,
+                                                NULL, NULL, true);
+    return oldConnection;
+}
+
+static void connect_old_client(void)
+{
+    run(500);
+    check(oldConnection->connected() != 0, "old client connected");
+}
+
+// Takes the older client away and gives the server time to notice.
+static void close_old_client(void)
+{
+    vrpn_Connection *old = oldConnection;
+    oldConnection = NULL;
+    old->removeReference();
+    run(500);
+}
+
+// Shuts everything down and reports.  Returns 0 if all is well, -1
+// otherwise.
+static int finish(void)
+{
+    delete remoteDevice;
+    delete serverDevice;
+    server->removeReference();
+
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return -1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
+
+#endif
@@ -4,9 +4,11 @@
 #include <stdio.h> // for FILE
 
 #include "vrpn_Configure.h" // for VRPN_USE_DEV_INPUT, etc
+#include "vrpn_Shared.h"    // for vrpn_vector
 #include "vrpn_Types.h"     // for vrpn_float64
 
 class vrpn_MainloopContainer;
+class vrpn_DeviceScheduler;
 
 /// @todo find out from the NDI specs if there is a maximum;
 const int VRPN_GSO_MAX_NDI_POLARIS_RIGIDBODIES = 20; 
@@ -23,7 +25,28 @@ public:
                                bool bail_on_open_error = false);
     ~vrpn_Generic_Server_Object();
 
+    /// Runs every device's mainloop(), or when the devices are running on
+    /// threads of their own, sends what they have reported and runs the
+    /// connection's mainloop() while they are paused.
     void mainloop(void);
+
+    /// Run the devices on num_threads threads of their own (see
+    /// vrpn_DeviceScheduler.h), each sleeping sleep_msecs between passes.
+    /// Returns false, leaving mainloop() to run them, if that fails.
+    bool run_devices_on_threads(unsigned num_threads, int sleep_msecs = 1);
+
+    /// True when mainloop() also runs the connection's mainloop().
+    bool devices_on_threads(void) const;
+
+    /// Event-driven replacement for calling the connection's mainloop()
+    /// and then sleeping: runs the connection's mainloop(), waiting in it
+    /// until a client sends something, a device has input on one of its
+    /// descriptors, or a device's max_wait_usecs() is up, but no longer
+    /// than max_wait_usecs (which is where to put the max_wait_usecs() of
+    /// any objects the caller runs itself).  Returns false, having done
+    /// nothing, if the connection can't wait on the devices' descriptors
+    /// or the devices are on threads of their own.
+    bool connection_mainloop_until_ready(vrpn_int32 max_wait_usecs = 1000000);
     inline bool doing_okay(void) const { return d_doing_okay; }
 
 protected:
@@ -36,6 +59,8 @@ protected:
     // Lists of devices
     vrpn_MainloopContainer *_devices; //< semi-pimpl idiom so we can use
                                       //<vector> and not scare Sensable GHOST.
+    vrpn_DeviceScheduler *d_scheduler; //< Runs _devices on threads, if asked
+    vrpn_vector<int> d_waitDescriptors; //< Reused by connection_mainloop_until_ready()
 
     void closeDevices(void);
 
@@ -157,6 +157,10 @@ SOURCE=.\vrpn_Connection.C
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_DeviceScheduler.C
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Dial.C
 # End Source File
 # Begin Source File
@@ -322,6 +326,10 @@ SOURCE=.\vrpn_SharedObject.C
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_ShmConnection.C
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Sound.C
 # End Source File
 # Begin Source File
@@ -338,6 +346,10 @@ SOURCE=.\vrpn_Streaming_Arduino.C
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_Telemetry.C
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Tng3.C
 # End Source File
 # Begin Source File
@@ -502,6 +514,10 @@ SOURCE=.\vrpn_Connection.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_DeviceScheduler.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Dial.h
 # End Source File
 # Begin Source File
@@ -662,6 +678,10 @@ SOURCE=.\vrpn_SharedObject.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_ShmConnection.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Sound.h
 # End Source File
 # Begin Source File
@@ -678,6 +698,10 @@ SOURCE=.\vrpn_Streaming_Arduino.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_Telemetry.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Tng3.h
 # End Source File
 # Begin Source File
@@ -25,6 +25,14 @@ const int vrpn_ANALOG_FAIL = (-2);
 // Analog time value meaning "go find out what time it is right now"
 const struct timeval vrpn_ANALOG_NOW = {0, 0};
 
+// How channel values are sent in compact reports; see
+// vrpn_Analog::setCompactEncoding().
+enum vrpn_ANALOG_ENCODING {
+    vrpn_ANALOG_FLOAT64 = 0, ///< Exact
+    vrpn_ANALOG_FLOAT32 = 1,
+    vrpn_ANALOG_INT16 = 2 ///< Nearest multiple of the channel's scale
+};
+
 class VRPN_API vrpn_Analog : public vrpn_BaseClass {
 public:
     vrpn_Analog(const char *name, vrpn_Connection *c = NULL);
@@ -34,19 +42,63 @@ public:
 
     vrpn_int32 getNumChannels(void) const;
 
+    /// Have report_changes() send only the channels that changed, with
+    /// their values in the given encoding, whenever every client connected
+    /// has said that it understands such compact reports (as
+    /// vrpn_Analog_Remote does); older clients keep getting full ones.
+    /// A full report still goes out at least every keyframe_msecs,
+    /// when a client connects, when the number of channels changes, and
+    /// when it would be smaller, so clients recover from lost messages.
+    /// vrpn_Analog_Remote rebuilds the full vector for its handlers.
+    void setCompactEncoding(vrpn_ANALOG_ENCODING encoding,
+                            vrpn_int32 keyframe_msecs = 1000);
+    /// Go back to sending full reports only.
+    void clearCompactEncoding(void);
+
+    /// Step between the values a channel can take in vrpn_ANALOG_INT16
+    /// compact reports, which hold up to 32767 steps either side of zero.
+    /// Defaults to 1.  Returns 0 on success, -1 on a bad channel or scale.
+    int setChannelScale(vrpn_int32 chan, vrpn_float64 scale);
+
 protected:
     vrpn_float64 channel[vrpn_CHANNEL_MAX];
     vrpn_float64 last[vrpn_CHANNEL_MAX];
     vrpn_int32 num_channel;
     struct timeval timestamp;
     vrpn_int32 channel_m_id; //< channel message id (message from server)
+    vrpn_int32 compact_m_id; //< changed channels only (message from server)
+    vrpn_int32 scales_m_id;  //< scales for vrpn_ANALOG_INT16 (from server)
+    vrpn_int32 compact_request_m_id; //< client understands compact reports
     int status;
 
+    /// Compact reports; see setCompactEncoding().
+    /// @{
+    bool d_compact;
+    vrpn_ANALOG_ENCODING d_compactEncoding;
+    vrpn_int32 d_keyframeMsecs;
+    bool d_connectHandlerRegistered;
+    vrpn_float64 d_channelScale[vrpn_CHANNEL_MAX];
+    struct timeval d_lastFullReport; ///< Zero to send a full one next
+    vrpn_int32 d_fullReportChannels; ///< num_channel in the last full one
+    vrpn_int32 d_fullReportEpoch;    ///< Counts full reports
+    vrpn_int32 d_compactSequence;    ///< Restarts at each full report
+    /// @}
+
     virtual int register_types(void);
 
     //------------------------------------------------------------------
     // Routines used to send data from the server
     virtual vrpn_int32 encode_to(char *buf);
+    /// Encode the count channels listed in which as a compact report.
+    virtual vrpn_int32 encode_compact_to(char *buf, const vrpn_uint8 *which,
+                                         vrpn_int32 count);
+    /// Send the channels that changed as a compact report if we can.
+    /// Returns false if a full report should be sent instead.
+    bool report_compact_changes(vrpn_uint32 class_of_service,
+                                const struct timeval time);
+    void send_channel_scales(void);
+    static int VRPN_CALLBACK handle_connection(void *userdata,
+                                               vrpn_HANDLERPARAM p);
     /// Send a report only if something has changed (for servers)
     /// Optionally, tell what time to stamp the value with
     virtual void
@@ -68,6 +120,9 @@ public:
                        bool rts_flow = false);
     ~vrpn_Serial_Analog();
 
+    /// Wake up when the serial port has input.
+    virtual void get_wait_descriptors(vrpn_vector<int> &fds);
+
 protected:
     int serial_fd;
     char portname[1024];
@@ -203,8 +258,32 @@ public:
 protected:
     vrpn_Callback_List<vrpn_ANALOGCB> d_callback_list;
 
+    /// Compact reports only change some channels, so they can be applied
+    /// only on top of the full report that they name and each compact one
+    /// since.  A full report can be dropped in favour of a newer one that
+    /// then arrives after the compact ones sent in between.
+    /// @{
+    bool d_haveFullReport;
+    bool d_haveScales;
+    vrpn_int32 d_baseEpoch; ///< Of the last full report
+    vrpn_int32 d_nextCompactSequence;
+    /// @}
+
     static int VRPN_CALLBACK
     handle_change_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_compact_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_scales_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_connection_made(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_connection_dropped(void *userdata, vrpn_HANDLERPARAM p);
+
+    /// Tell the server that we understand compact reports.
+    void request_compact_reports(void);
+
+    void call_change_handlers(const struct timeval &msg_time);
 };
 
 #endif
@@ -195,6 +195,20 @@ public:
 
     bool shutup; // if True, don't print the "No response from server" messages.
 
+    /// @name Event-driven servers
+    /// A server that sleeps until something happens, rather than for a
+    /// fixed time each time through its loop, asks each object what its
+    /// mainloop() is waiting for and calls it again as soon as one of its
+    /// descriptors is readable or max_wait_usecs() has gone by.  Objects
+    /// that don't say are called every millisecond, as when polled.
+    /// @{
+    /// Adds the descriptors whose input mainloop() handles to fds.
+    virtual void get_wait_descriptors(vrpn_vector<int> & /*fds*/) {}
+    /// How long the server may wait before calling mainloop() when none of
+    /// the descriptors is readable, in microseconds; -1 for no limit.
+    virtual vrpn_int32 max_wait_usecs(void) { return 1000; }
+    /// @}
+
     friend class SendTextMessageBoundCall;
     class SendTextMessageBoundCall {
     private:
@@ -266,6 +280,11 @@ protected:
         return SendTextMessageBoundCall(this, type);
     }
 
+    /// For max_wait_usecs(): time left until the next report is due for a
+    /// device that reports rate_hz times per second and last did at last.
+    static vrpn_int32 usecs_until_next_report(const struct timeval &last,
+                                              vrpn_float64 rate_hz);
+
     /// Handles functions that all servers should provide in their mainloop()
     /// (ping/pong, for example)
     /// Should be called by all servers in their mainloop()
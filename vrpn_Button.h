@@ -48,6 +48,8 @@ protected:
     vrpn_int32 num_buttons;
     struct timeval timestamp;
     vrpn_int32 change_message_id; // ID of change button message to connection
+    vrpn_int32 changes_message_id; // ID of several-changes message
+    vrpn_int32 changes_request_message_id; // Client understands changes msgs
     vrpn_int32 states_message_id; // ID of button-states message to connection
     vrpn_int32 admin_message_id;  // ID of admin button message to connection
 
@@ -57,6 +59,17 @@ protected:
     virtual vrpn_int32 encode_to(char *buf, vrpn_int32 button,
                                  vrpn_int32 state);
     virtual vrpn_int32 encode_states_to(char *buf);
+    /// Encode count changes (which[i] went to state[i]) as one message.
+    virtual vrpn_int32 encode_changes_to(char *buf, const vrpn_int32 *which,
+                                         const vrpn_int32 *state,
+                                         vrpn_int32 count);
+    /// Send the changes found by report_changes(): as one message if there
+    /// are several and every client connected has said that it understands
+    /// those (as vrpn_Button_Remote does), one message per button if not.
+    void send_changes(const vrpn_int32 *which, const vrpn_int32 *state,
+                      vrpn_int32 count);
+    /// Whether send_changes() would send count changes as one message.
+    bool changes_go_together(vrpn_int32 count);
 };
 
 /** All button servers should derive from this class, which provides
@@ -125,6 +138,9 @@ public:
 
     virtual void mainloop();
 
+    /// Only needs to run when the next toggle is due.
+    virtual vrpn_int32 max_wait_usecs(void);
+
 protected:
     vrpn_float64 _update_rate; // How often to toggle
 };
@@ -177,6 +193,9 @@ public:
                        const char *port = "/dev/ttyS1/", long baud = 38400);
     virtual ~vrpn_Button_Serial();
 
+    /// Wake up when the serial port has input.
+    virtual void get_wait_descriptors(vrpn_vector<int> &fds);
+
 protected:
     char portname[VRPN_BUTTON_BUF_SIZE];
     long baudrate;
@@ -287,6 +306,13 @@ protected:
     vrpn_Callback_List<vrpn_BUTTONCB> d_callback_list;
     static int VRPN_CALLBACK
     handle_change_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_changes_message(void *userdata, vrpn_HANDLERPARAM p);
+
+    /// Tell the server that we understand several-changes messages.
+    void request_changes_messages(void);
+    static int VRPN_CALLBACK
+    handle_connection_made(void *userdata, vrpn_HANDLERPARAM p);
 
     vrpn_Callback_List<vrpn_BUTTONSTATESCB> d_states_callback_list;
     static int VRPN_CALLBACK
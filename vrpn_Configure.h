@@ -44,6 +44,12 @@
 // haven't been tested for extreme portability.
 //#define VRPN_USE_STATIC_ASSERTIONS
 
+//-----------------------
+// Have vrpn_Connection_IP wait on all of its sockets with a single
+// epoll descriptor (Linux only), servicing only the endpoints that have
+// data waiting, rather than calling select() once per endpoint.
+//#define VRPN_USE_EPOLL
+
 //-----------------------
 // Use Winsock2 library rather than Winsock.
 //#define	VRPN_USE_WINSOCK2
@@ -94,6 +94,12 @@ const int vrpn_CONNECTION_TCP_BUFLEN = 64000;
 const int vrpn_CONNECTION_UDP_BUFLEN = 1472;
 /// @}
 
+/// @brief Number of UDP datagrams an endpoint gathers before sending
+/// them all at once, and the most it will read from the socket at once.
+/// Where the system has sendmmsg() and recvmmsg() each batch is one call.
+
+const int vrpn_CONNECTION_UDP_BATCH = 16;
+
 /// @brief Number of endpoints that a server connection can have.  Arbitrary
 /// limit.
 
@@ -123,6 +129,140 @@ const vrpn_uint32 vrpn_CONNECTION_HIGH_THROUGHPUT = (1 << 4);
 
 /// @}
 
+/// @brief What an endpoint does when more outgoing TCP data is waiting for a
+/// slow receiver than its send-queue limit allows.
+///
+/// Data that the receiver has not yet accepted is kept in a per-endpoint
+/// queue so that one slow client does not stall the sender.  Messages that
+/// were packed RELIABLE are never discarded, so the queue can still grow
+/// past the limit when a receiver cannot keep up with reliable traffic.
+enum vrpn_SendQueuePolicy {
+    vrpn_SEND_QUEUE_BLOCK,           ///< Wait for the receiver to catch up
+    vrpn_SEND_QUEUE_DROP_UNRELIABLE, ///< Drop the oldest non-RELIABLE msgs
+    vrpn_SEND_QUEUE_COALESCE,   ///< Keep newest non-RELIABLE msg per type/sender
+    vrpn_SEND_QUEUE_DISCONNECT  ///< Drop the connection to the receiver
+};
+
+/// @brief Default number of bytes that may wait in an endpoint's send queue
+/// before its vrpn_SendQueuePolicy is applied.
+const vrpn_uint32 vrpn_CONNECTION_SEND_QUEUE_LIMIT = 1024 * 1024;
+
+/// @brief Space for one outgoing message payload that can be sent to many
+/// endpoints without being copied into each of their buffers.
+///
+/// Frames are reference counted: vrpn_Connection holds the one that
+/// reserve_message() handed out, and each endpoint that has not sent it
+/// yet holds another.  The storage is aligned for vrpn_float64 and has room
+/// for the padding out to a multiple of vrpn_ALIGN bytes.
+class VRPN_API vrpn_MessageFrame {
+public:
+    /// Returns a frame holding one reference, or NULL if out of memory.
+    static vrpn_MessageFrame *create(vrpn_uint32 capacity);
+
+    void addReference(void) { d_references++; }
+    /// Deletes the frame once the last reference is removed.
+    void removeReference(void);
+    bool isShared(void) const { return d_references > 1; }
+
+    char *payload(void) { return reinterpret_cast<char *>(d_storage); }
+    vrpn_uint32 capacity(void) const { return d_capacity; }
+
+protected:
+    vrpn_MessageFrame(void);
+    ~vrpn_MessageFrame(void);
+
+    vrpn_float64 *d_storage;
+    vrpn_uint32 d_capacity;
+    unsigned d_references;
+};
+
+/// @brief Counts of durations in microseconds, in power-of-two buckets.
+///
+/// Bucket 0 counts durations under 1 us and bucket i those from 2^(i-1)
+/// up to 2^i us; the last bucket also counts everything longer.
+class VRPN_API vrpn_LatencyHistogram {
+public:
+    enum { NUM_BUCKETS = 24 };
+
+    vrpn_LatencyHistogram(void) { clear(); }
+    void clear(void);
+    void add(vrpn_uint32 usec);
+
+    vrpn_uint32 count(void) const { return d_count; }
+    vrpn_uint32 bucket(int which) const { return d_buckets[which]; }
+    vrpn_float64 total_usec(void) const { return d_totalUsec; }
+    vrpn_uint32 max_usec(void) const { return d_maxUsec; }
+
+    /// Upper end of the bucket holding the duration that fraction (0 to 1)
+    /// of the others are no longer than, or the longest if that is less.
+    /// Returns 0 if there are none.
+    vrpn_uint32 percentile_usec(vrpn_float64 fraction) const;
+
+    /// Pack into and unpack from a message, as vrpn_buffer() and
+    /// vrpn_unbuffer() do.  Return 0 on success, -1 on failure.
+    int buffer(char **insertPt, vrpn_int32 *buflen) const;
+    int unbuffer(const char **buffer);
+
+protected:
+    vrpn_uint32 d_buckets[NUM_BUCKETS];
+    vrpn_uint32 d_count;
+    vrpn_float64 d_totalUsec;
+    vrpn_uint32 d_maxUsec;
+};
+
+/// @brief Traffic of one message type through one endpoint.
+struct VRPN_API vrpn_TypeTelemetry {
+    vrpn_TypeTelemetry(void) { clear(); }
+    void clear(void);
+
+    vrpn_uint32 messages_sent;
+    vrpn_float64 bytes_sent; ///< Payload bytes
+    vrpn_uint32 messages_received;
+    vrpn_float64 bytes_received;         ///< Payload bytes
+    vrpn_LatencyHistogram callback_usec; ///< Time in the type's handlers
+};
+
+/// @brief What an endpoint counts while its connection's telemetry is on.
+/// See vrpn_Connection::set_telemetry().
+struct VRPN_API vrpn_EndpointTelemetry {
+    vrpn_EndpointTelemetry(void);
+    void clear(void);
+
+    /// The counts for a local type ID, growing the table to hold it.
+    /// Returns NULL for system types or if out of memory.
+    vrpn_TypeTelemetry *type(vrpn_int32 local_type);
+
+    struct timeval since; ///< When counting started
+
+    /// @name All messages, including system ones
+    /// @{
+    vrpn_uint32 messages_sent;
+    vrpn_float64 bytes_sent; ///< Payload bytes
+    vrpn_uint32 messages_received;
+    vrpn_float64 bytes_received; ///< Payload bytes
+    /// @}
+
+    /// @name Output buffers
+    /// Bytes include message headers.
+    /// @{
+    vrpn_uint32 tcp_outbuf_high_water; ///< Most bytes waiting in it at once
+    vrpn_uint32 udp_outbuf_high_water; ///< Including full datagrams
+    vrpn_uint32 tcp_flushes;           ///< Times its contents were sent
+    vrpn_float64 tcp_bytes_flushed;
+    vrpn_uint32 udp_datagrams_sent;
+    vrpn_float64 udp_bytes_sent;
+    /// Times a message did not fit, so the buffers were sent in the
+    /// middle of packing rather than at the end of mainloop()
+    vrpn_uint32 forced_flushes;
+    /// @}
+
+    /// Time in the handlers of all user types
+    vrpn_LatencyHistogram callback_usec;
+
+    /// Indexed by local type ID; user types only
+    vrpn_vector<vrpn_TypeTelemetry> types;
+};
+
 /// @name What to log
 /// @{
 const long vrpn_LOG_NONE = (0);
@@ -267,6 +407,10 @@ public:
     /// Returns the local mapping for the remote sender (-1 if none).
     int local_sender_id(vrpn_int32 remote_sender) const;
 
+    /// Returns true if the other side has sent at least one message of
+    /// local_type since it connected.
+    vrpn_bool peer_has_sent(vrpn_int32 local_type) const;
+
     virtual vrpn_bool doing_okay(void) const = 0;
     /// @}
 
@@ -304,6 +448,14 @@ public:
                              const char *buffer,
                              vrpn_uint32 class_of_service) = 0;
 
+    /// Pack a message whose payload is the first len bytes of frame.
+    /// Endpoints that can send it by reference add a reference to the
+    /// frame; by default this copies it in with pack_message().
+    virtual int pack_shared_message(vrpn_MessageFrame *frame, vrpn_uint32 len,
+                                    struct timeval time, vrpn_int32 type,
+                                    vrpn_int32 sender,
+                                    vrpn_uint32 class_of_service);
+
     /// send pending report, clear the buffer.
     /// This function was protected, now is public, so we can use it
     /// to send out intermediate results without calling mainloop
@@ -375,11 +527,33 @@ public:
     /// @name Routines to inform the endpoint of the connection of
     /// which it is a part.
     /// @{
-    void setConnection(vrpn_Connection *conn) { d_parent = conn; }
+    void setConnection(vrpn_Connection *conn);
     vrpn_Connection *getConnection() { return d_parent; }
     /// @}
 
+    /// @name Telemetry
+    /// What this endpoint has counted since its connection's telemetry
+    /// was turned on (or last reset), or NULL if it is off.
+    /// @{
+    const vrpn_EndpointTelemetry *telemetry(void) const
+    {
+        return d_telemetry;
+    }
+    void set_telemetry(bool on);
+    void reset_telemetry(void);
+    /// @}
+
 protected:
+    vrpn_EndpointTelemetry *d_telemetry;
+
+    /// Count a message packed for sending, or one whose handlers were
+    /// called starting at start; only call with telemetry on.
+    /// @{
+    void count_sent(vrpn_int32 type, vrpn_uint32 len);
+    void count_callbacks(vrpn_int32 local_type, vrpn_uint32 payload_len,
+                         const struct timeval &start);
+    /// @}
+
     virtual int dispatch(vrpn_int32 type, vrpn_int32 sender, timeval time,
                          vrpn_uint32 payload_len, char *bufptr);
 
@@ -391,6 +565,13 @@ protected:
     ///< send_pending_reports() and then marshalls again.
     ///< Returns the number of characters successfully marshalled.
 
+    static vrpn_uint32 marshall_header(char *outbuf, vrpn_uint32 len,
+                                       struct timeval time, vrpn_int32 type,
+                                       vrpn_int32 sender,
+                                       vrpn_uint32 sequenceNumber);
+    ///< Fills in the header of a message with a payload of len bytes.
+    ///< Returns the length of the header, including its padding.
+
     int marshall_message(char *outbuf, vrpn_uint32 outbuf_size,
                          vrpn_uint32 initial_out, vrpn_uint32 len,
                          struct timeval time, vrpn_int32 type,
@@ -406,6 +587,9 @@ protected:
     vrpn_TranslationTable *d_senders;
     vrpn_TranslationTable *d_types;
 
+    /// Which local types the other side has sent us messages of
+    vrpn_vector<bool> d_typesReceived;
+
     vrpn_TypeDispatcher *d_dispatcher;
     vrpn_int32 *d_connectionCounter;
 
@@ -453,6 +637,12 @@ public:
                      vrpn_int32 sender, const char *buffer,
                      vrpn_uint32 class_of_service);
 
+    /// @brief Large reliable messages go onto the TCP send queue holding
+    /// a reference to the frame, rather than being copied into d_tcpOutbuf.
+    int pack_shared_message(vrpn_MessageFrame *frame, vrpn_uint32 len,
+                            struct timeval time, vrpn_int32 type,
+                            vrpn_int32 sender, vrpn_uint32 class_of_service);
+
     /// @brief send pending report, clear the buffer.
     ///
     /// This function was protected, now is public, so we can use it
@@ -464,6 +654,36 @@ public:
     int handle_tcp_messages(const timeval *timeout);
     int handle_udp_messages(const timeval *timeout);
 
+    /// @name Outgoing TCP queue
+    /// TCP data that the receiver has not accepted yet is queued here
+    /// rather than blocking the sender; see vrpn_SendQueuePolicy.
+    /// @{
+    /// Override the connection's policy and limit for this endpoint.
+    void set_send_queue_policy(vrpn_SendQueuePolicy policy,
+                               vrpn_uint32 limit_bytes);
+    vrpn_SendQueuePolicy send_queue_policy(void) const;
+    vrpn_uint32 send_queue_limit(void) const;
+    /// Bytes and messages waiting to be sent
+    vrpn_uint32 send_queue_bytes(void) const { return d_sendQueueBytes; }
+    vrpn_uint32 send_queue_messages(void) const { return d_sendQueueMessages; }
+    /// Messages discarded by the policy since the endpoint was created
+    vrpn_uint32 send_queue_dropped(void) const { return d_sendQueueDropped; }
+    /// @}
+
+    /// True if a complete TCP message is waiting in our receive buffer.
+    /// These were read from the socket already, so they will not show
+    /// up as readable in a select().
+    bool tcp_message_buffered(void) const;
+
+    /// @brief Read from whichever of our sockets have been found to be
+    /// ready by a select() or by the connection's event reactor.
+    /// Sets status to BROKEN and returns -1 on failure.
+    int handle_ready_sockets(bool tcp_ready, bool udp_ready);
+
+    /// Socket on which inbound unreliable messages arrive, or
+    /// INVALID_SOCKET if there is none.
+    vrpn_SOCKET udp_inbound_socket(void) const { return d_udpInboundSocket; }
+
     int connect_tcp_to(const char *msg);
     int connect_tcp_to(const char *addr, int port);
     ///< Connects d_tcpSocket to the specified address (msg = "IP port");
@@ -521,9 +741,26 @@ public:
     ///< end to open a UDP link to their counterparts.  If this is
     ///< the case, then this flag should be set to true.
 
+    /// @name Event reactor bookkeeping
+    /// Which of our sockets the parent connection's event reactor has
+    /// registered, under which endpoint index, and whether it is waiting
+    /// for the TCP socket to take more of the send queue.  Only touched by
+    /// vrpn_Connection_IP; reset when our sockets are closed.
+    /// @{
+    vrpn_SOCKET d_reactorTcpSocket;
+    vrpn_SOCKET d_reactorUdpSocket;
+    size_t d_reactorIndex;
+    bool d_reactorWritable;
+    /// @}
+
 protected:
-    int getOneTCPMessage(int fd, char *buf, size_t buflen);
+    int getOneTCPMessage(void);
     int getOneUDPMessage(char *buf, size_t buflen);
+    int fillTCPInbuf(void);
+    int marshall_udp_message(vrpn_uint32 len, timeval time, vrpn_int32 type,
+                             vrpn_int32 sender, const char *buffer);
+    int send_udp_datagrams(void);
+    int receive_udp_datagrams(int lengths[vrpn_CONNECTION_UDP_BATCH]);
 
     vrpn_SOCKET d_udpOutboundSocket;
     vrpn_SOCKET d_udpInboundSocket;
@@ -540,6 +777,13 @@ protected:
     vrpn_int32 d_tcpNumOut;
     vrpn_int32 d_udpNumOut;
 
+    /// d_udpOutbuf holds vrpn_CONNECTION_UDP_BATCH datagrams of d_udpBuflen
+    /// bytes each.  The first d_udpNumDatagrams of them are full and wait
+    /// to be sent, with their lengths in d_udpDatagramLen; messages are
+    /// marshalled into the one after that, which holds d_udpNumOut bytes.
+    int d_udpNumDatagrams;
+    vrpn_int32 d_udpDatagramLen[vrpn_CONNECTION_UDP_BATCH];
+
     vrpn_int32 d_tcpSequenceNumber;
     vrpn_int32 d_udpSequenceNumber;
 
@@ -547,14 +791,87 @@ protected:
         d_tcpAlignedInbuf[vrpn_CONNECTION_TCP_BUFLEN / sizeof(vrpn_float64) +
                           1];
     vrpn_float64
-        d_udpAlignedInbuf[vrpn_CONNECTION_UDP_BUFLEN / sizeof(vrpn_float64) +
+        d_udpAlignedInbuf[vrpn_CONNECTION_UDP_BATCH]
+                         [vrpn_CONNECTION_UDP_BUFLEN / sizeof(vrpn_float64) +
                           1];
     char *d_tcpInbuf;
     char *d_udpInbuf;
 
+    /// The TCP receive buffer is filled with as much as the socket has
+    /// available in one recv(), and messages are dispatched straight out
+    /// of it.  Bytes before d_tcpInbufHead have been handled; bytes from
+    /// there up to d_tcpInbufFill are waiting to be parsed.
+    size_t d_tcpInbufHead;
+    size_t d_tcpInbufFill;
+
+    /// Queue of TCP messages waiting for a slow receiver, oldest first.
+    struct SendQueueEntry;
+    SendQueueEntry *d_sendQueueHead;
+    SendQueueEntry *d_sendQueueTail;
+    vrpn_uint32 d_sendQueueBytes;
+    vrpn_uint32 d_sendQueueMessages;
+    vrpn_uint32 d_sendQueueDropped;
+    bool d_sendQueueOverride; ///< Use our own policy rather than parent's
+    vrpn_SendQueuePolicy d_sendQueuePolicy;
+    vrpn_uint32 d_sendQueueLimit;
+
+    /// Offsets into d_tcpOutbuf of messages that were not packed RELIABLE
+    /// (they only go over TCP when there is no UDP channel).
+    vrpn_vector<vrpn_uint32> d_tcpUnreliableOffsets;
+
+    int send_tcp_without_blocking(void);
+    int enqueue_tcp_outbuf(vrpn_uint32 already_sent);
+    int enqueue_shared_message(vrpn_MessageFrame *frame, vrpn_uint32 len,
+                               timeval time, vrpn_int32 type,
+                               vrpn_int32 sender,
+                               vrpn_uint32 class_of_service);
+    int wait_for_send_queue(vrpn_uint32 limit);
+    int enforce_send_queue_limit(void);
+    void drop_queue_entry(SendQueueEntry *prev, SendQueueEntry *entry);
+    void drop_superseded(vrpn_int32 type, vrpn_int32 sender);
+    void clear_send_queue(void);
+
     char *d_NICaddress;
 };
 
+/// @brief Takes the messages that threads other than the connection's own
+/// pack, so that they can be handed to the connection later from the
+/// thread that runs its mainloop().  See
+/// vrpn_Connection::set_message_redirect().
+class VRPN_API vrpn_MessageRedirect {
+public:
+    virtual ~vrpn_MessageRedirect(void) {}
+
+    /// True if messages packed by the calling thread should come here
+    /// rather than going to the endpoints.
+    virtual bool redirecting(void) = 0;
+
+    /// Take a message that would have been packed; same arguments and
+    /// return value as vrpn_Connection::pack_message().
+    virtual int redirect_message(vrpn_uint32 len, struct timeval time,
+                                 vrpn_int32 type, vrpn_int32 sender,
+                                 const char *buffer,
+                                 vrpn_uint32 class_of_service) = 0;
+
+    /// Stand-ins for vrpn_Connection::reserve_message() and
+    /// commit_message(); the space must be aligned for vrpn_float64.
+    /// @{
+    virtual char *redirect_reserve(vrpn_uint32 max_len) = 0;
+    virtual int redirect_commit(vrpn_uint32 len, struct timeval time,
+                                vrpn_int32 type, vrpn_int32 sender,
+                                vrpn_uint32 class_of_service) = 0;
+    /// @}
+
+    /// Hold whatever threads the messages come from, and let them go.
+    /// The connection calls these around each dispatch of a message to
+    /// its handlers, since any handler may touch a device.  Calls pair up
+    /// and do not nest.
+    /// @{
+    virtual void pause_devices(void) {}
+    virtual void resume_devices(void) {}
+    /// @}
+};
+
 /// @brief Generic connection class not specific to the transport mechanism.
 ///
 /// It abstracts all of the common functions.  Specific implementations
@@ -608,6 +925,17 @@ public:
     /// and this timeout will be divided evenly between them.
     virtual int mainloop(const struct timeval *timeout = NULL) = 0;
 
+    /// Have mainloop() also stop waiting when any of these descriptors
+    /// (the devices' serial ports, say) has input, replacing any given
+    /// before.  That lets a server sleep in mainloop() until there is
+    /// something for it to do.  Returns 0 on success, -1 if this
+    /// connection can't (without VRPN_USE_EPOLL, for example), in which
+    /// case its mainloop() only waits on its own sockets.
+    virtual int wait_on_descriptors(const vrpn_vector<int> & /*fds*/)
+    {
+        return -1;
+    }
+
     /// Get a token to use for the string name of the sender or type.
     /// Remember to check for -1 meaning failure.
     virtual vrpn_int32 register_sender(const char *name);
@@ -631,6 +959,20 @@ public:
                              vrpn_int32 type, vrpn_int32 sender,
                              const char *buffer, vrpn_uint32 class_of_service);
 
+    /// @name Packing without a copy per endpoint
+    /// reserve_message() returns space for a payload of up to max_len bytes
+    /// (aligned for vrpn_float64) that the caller encodes the message into,
+    /// then commit_message() packs the first len bytes of it like
+    /// pack_message() does.  The payload is shared by all endpoints rather
+    /// than copied into each one.  Only one message may be reserved at a
+    /// time; the space is not valid after commit_message().
+    /// reserve_message() returns NULL if max_len is too large to send.
+    /// @{
+    char *reserve_message(vrpn_uint32 max_len);
+    int commit_message(vrpn_uint32 len, struct timeval time, vrpn_int32 type,
+                       vrpn_int32 sender, vrpn_uint32 class_of_service);
+    /// @}
+
     /// send pending report, clear the buffer.
     /// This function was protected, now is public, so we can use it
     /// to send out intermediate results without calling mainloop
@@ -662,6 +1004,35 @@ public:
     /// Save any messages on any endpoints which have been logged so far.
     virtual int save_log_so_far();
 
+    /// @name Streaming logs
+    /// Logs normally keep every message in memory until save_log_so_far()
+    /// or the log is closed.  With a nonzero buffer_bytes, each log instead
+    /// hands its messages to a writer thread through a ring of that size,
+    /// which writes them out in large blocks and flushes the file at least
+    /// every flush_msecs.  Messages that arrive while the ring is full are
+    /// dropped and counted.  Applies to current and future endpoints.
+    /// @{
+    void set_log_streaming(vrpn_uint32 buffer_bytes,
+                           vrpn_uint32 flush_msecs = 1000);
+    vrpn_uint32 log_stream_buffer(void) const { return d_logStreamBytes; }
+    vrpn_uint32 log_stream_flush_msecs(void) const
+    {
+        return d_logStreamFlushMsecs;
+    }
+    vrpn_uint32 log_entries_dropped(void) const;
+    /// @}
+
+    /// @brief Send messages packed on other threads through redirect.
+    /// A connection is not thread-safe, but devices can still run on
+    /// threads of their own if something hands their messages over to the
+    /// connection's thread.  While a redirect is set, pack_message(),
+    /// reserve_message() and commit_message() called on a thread for which
+    /// redirect->redirecting() is true go to it instead, and mainloop()
+    /// called on such a thread does nothing.  Message handlers run with
+    /// redirect->pause_devices() in effect.  Pass NULL to remove it; the
+    /// connection does not own it.
+    void set_message_redirect(vrpn_MessageRedirect *redirect);
+
     /// vrpn_File_Connection implements this as "return this" so it
     /// can be used to detect a File_Connection and get the pointer for it
     virtual vrpn_File_Connection *get_File_Connection(void);
@@ -695,12 +1066,109 @@ public:
         return d_stop_processing_messages_after;
     };
 
+    /// @name Outgoing queues for slow receivers
+    /// Reliable data that a receiver has not accepted yet is queued on its
+    /// endpoint rather than blocking the sender.  These set the policy
+    /// applied when a queue grows past limit_bytes, for every endpoint
+    /// that has not had its own set with
+    /// vrpn_Endpoint_IP::set_send_queue_policy().
+    /// @{
+    void set_send_queue_policy(vrpn_SendQueuePolicy policy,
+                               vrpn_uint32 limit_bytes);
+    vrpn_SendQueuePolicy send_queue_policy(void) const
+    {
+        return d_sendQueuePolicy;
+    }
+    vrpn_uint32 send_queue_limit(void) const { return d_sendQueueLimit; }
+
+    /// Number of endpoints, and access to each by index (0 to count-1),
+    /// for querying and setting their send queues.  Indices change as
+    /// clients connect and disconnect.
+    unsigned endpoint_count(void) const;
+    vrpn_Endpoint_IP *get_endpoint(unsigned which) const;
+    /// @}
+
+    /// @name Telemetry
+    /// While it is on, each endpoint counts the messages and bytes it sends
+    /// and receives, in total and by type; how full its output buffers get
+    /// and how often they are sent; how often a message does not fit and
+    /// forces them out in the middle of packing; and how long the handlers
+    /// for each type take.  Read them with get_endpoint(i)->telemetry(),
+    /// or publish them with a vrpn_Telemetry_Server.  Off by default,
+    /// since timing the handlers reads the clock twice for each message.
+    /// Counters are plain integers, only touched by the thread that runs
+    /// the connection.
+    /// @{
+    void set_telemetry(bool on);
+    bool telemetry(void) const { return d_telemetry; }
+    /// Start every endpoint counting again from zero.
+    void reset_telemetry(void);
+    /// @}
+
+    /// Returns true if every connected peer has sent at least one message
+    /// of this type since it connected.  Devices whose remotes send such a
+    /// message to say they understand a newer kind of report use this to
+    /// decide whether they can send it in place of one that older clients
+    /// still expect.  (Every peer learns the names of all of the other
+    /// side's types, so knowing the type itself says nothing.)
+    vrpn_bool peers_have_sent(vrpn_int32 type) const;
+
+    /// @brief Only the newest unsent message of this type from each sender
+    /// matters to a receiver that has fallen behind.
+    ///
+    /// A message of the type that is not packed RELIABLE replaces any
+    /// older one of the same type from the same sender still waiting in
+    /// an endpoint's send queue, whatever the queue's policy and however
+    /// full it is, so a slow client gets the latest value rather than a
+    /// backlog.  Only for types whose every message carries the sender's
+    /// whole state; not, for example, tracker reports, which share one
+    /// type across sensors.
+    void set_latest_value_only(vrpn_int32 type, bool latest_only = true);
+    bool latest_value_only(vrpn_int32 type) const
+    {
+        return (type >= 0) &&
+               (static_cast<size_t>(type) < d_latestValueOnly.size()) &&
+               d_latestValueOnly[type];
+    }
+
 protected:
     /// If this value is greater than zero, the connection should stop
     /// looking for new messages on a given endpoint after this many
     /// are found.
     vrpn_uint32 d_stop_processing_messages_after;
 
+    vrpn_SendQueuePolicy d_sendQueuePolicy;
+    vrpn_uint32 d_sendQueueLimit;
+    vrpn_vector<bool> d_latestValueOnly; ///< Indexed by type
+
+    /// Payload space handed out by reserve_message()
+    vrpn_MessageFrame *d_reservedFrame;
+    /// Payload copies made by pack_message(), kept apart from
+    /// d_reservedFrame so that they never land in a caller's reservation
+    vrpn_MessageFrame *d_packedFrame;
+
+    vrpn_uint32 d_logStreamBytes; ///< Log ring size; 0 keeps logs in memory
+    vrpn_uint32 d_logStreamFlushMsecs;
+
+    vrpn_MessageRedirect *d_redirect; ///< See set_message_redirect()
+
+    bool d_telemetry; ///< Endpoints count their traffic; see set_telemetry()
+
+    /// True if this thread's messages go to d_redirect.
+    bool redirected(void) const
+    {
+        return (d_redirect != NULL) && d_redirect->redirecting();
+    }
+
+    int pack_to_endpoints(vrpn_uint32 len, struct timeval time,
+                          vrpn_int32 type, vrpn_int32 sender,
+                          const char *buffer, vrpn_MessageFrame *frame,
+                          vrpn_uint32 class_of_service);
+    /// Pack the first len bytes of frame's payload to all endpoints.
+    int pack_frame(vrpn_MessageFrame *frame, vrpn_uint32 len,
+                   struct timeval time, vrpn_int32 type, vrpn_int32 sender,
+                   vrpn_uint32 class_of_service);
+
     int connectionStatus; ///< Status of the connection
 
     /// Redefining this and passing it to constructors
@@ -875,6 +1343,9 @@ public:
     /// and this timeout will be divided evenly between them.
     virtual int mainloop(const struct timeval *timeout = NULL);
 
+    /// Supported when the event reactor is in use.
+    virtual int wait_on_descriptors(const vrpn_vector<int> &fds);
+
 protected:
     /// If this value is greater than zero, the connection should stop
     /// looking for new messages on a given endpoint after this many
@@ -932,6 +1403,28 @@ protected:
     void drop_connection_and_compact(vrpn_Endpoint *endpoint);
 
     char *d_NIC_IP;
+
+    /// @name Readiness-based event reactor
+    /// When VRPN_USE_EPOLL is defined, mainloop() registers the listen
+    /// sockets and the TCP and UDP inbound sockets of every connected
+    /// endpoint with a single epoll descriptor and only services the
+    /// endpoints that have something to read, rather than doing a
+    /// select() per endpoint.  While an endpoint has data on its send
+    /// queue, its TCP socket is also watched for writing, so the queue
+    /// goes out as soon as the receiver can take it.  Falls back to
+    /// select() if the descriptor cannot be created.
+    /// @{
+    int d_reactorFd;        ///< epoll descriptor, -1 when not in use
+    bool d_reactorDisabled; ///< Set if the reactor could not be opened
+    vrpn_vector<int> d_reactorWaitFds; ///< From wait_on_descriptors()
+    timeval d_reactorWaitRefresh; ///< When they were last all re-registered
+    int reactor_open(void);
+    void reactor_close(void);
+    int reactor_watch(vrpn_SOCKET &registered, vrpn_SOCKET wanted,
+                      vrpn_uint32 key, bool rekey, bool writable = false);
+    int reactor_sync_endpoint(vrpn_Endpoint_IP *endpoint, size_t index);
+    int reactor_mainloop(const struct timeval *timeout);
+    /// @}
 };
 
 /// @brief Constructor for a Loopback connection that will basically just
@@ -982,8 +1475,10 @@ protected:
 };
 
 /// @brief Create a client connection of arbitrary type (VRPN UDP/TCP, TCP,
-/// File, Loopback, MPI).
+/// File, Loopback, MPI, shared memory).
 ///
+/// A name like "shm:segment_name" connects through shared memory to a
+/// server on the same host; see vrpn_ShmConnection.h.
 /// WARNING:  May not be thread safe.
 /// If no IP address for the NIC to use is specified, uses the default
 /// NIC.  If the force_reopen flag is set, a new connection will be
@@ -998,7 +1493,7 @@ VRPN_API vrpn_Connection *vrpn_get_connection_by_name(
     const char *NIC_IPaddress = NULL, bool force_reopen = false);
 
 /// @brief Create a server connection of arbitrary type (VRPN UDP/TCP,
-/// TCP, File, Loopback, MPI).
+/// TCP, File, Loopback, MPI, shared memory).
 ///
 /// Returns NULL if the name is not understood or the connection cannot
 /// be created.
@@ -1011,6 +1506,9 @@ VRPN_API vrpn_Connection *vrpn_get_connection_by_name(
 /// To create an MPI server, use a name like:
 ///    mpi:MPI_COMM_WORLD
 ///    mpi:comm_number
+/// To create a server for clients on the same host that talk to it
+/// through shared memory, use a name like:
+///    shm:segment_name
 /// When done with the object, call removeReference() on it (which will
 /// delete it if there are no other references).
 VRPN_API vrpn_Connection *
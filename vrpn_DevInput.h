@@ -50,6 +50,10 @@ public:
 
     virtual void mainloop();
 
+    /// Runs when the event device has input; there is nothing else to do.
+    virtual void get_wait_descriptors(vrpn_vector<int> &fds);
+    virtual vrpn_int32 max_wait_usecs(void) { return -1; }
+
 protected:  // methods
     /// Try to read reports from the device.
     /// Returns 1 if msg received, or 0 if none received.
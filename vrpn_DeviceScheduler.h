@@ -0,0 +1,117 @@
+#ifndef VRPN_DEVICESCHEDULER_H
+#define VRPN_DEVICESCHEDULER_H
+
+// vrpn_DeviceScheduler
+//
+// Runs the devices in a vrpn_MainloopContainer on worker threads, so that
+// a device waiting on a slow serial port or USB read does not hold up the
+// others or the network.  The devices all share one server connection,
+// which is not thread-safe, so:
+//   - each worker collects the messages its devices pack in a queue of
+//     its own rather than sending them, and
+//   - the thread that owns the connection calls mainloop() here in place
+//     of the connection's mainloop().  That takes each worker's latest
+//     batch of messages, packs them into the connection (so each endpoint
+//     sends the whole batch at once) and runs the connection's mainloop().
+// Workers never wait on each other.  They wait on the connection's thread
+// only to swap one queue for another, and while it dispatches a message:
+// any handler may touch any device, so the connection holds every worker
+// between passes (see pause_devices()) until the message's handlers are
+// done.  Waiting for messages holds no one, so a slow device does not
+// hold up the other devices, nor the network except for the handlers of
+// messages that arrive during its pass.  A connection may only have one
+// scheduler.  Devices must register their senders,
+// message types and handlers before they are started; start() runs each
+// of them once first for the ones that do that in their first mainloop().
+
+#include "vrpn_Configure.h"  // for VRPN_API
+#include "vrpn_Connection.h" // for vrpn_MessageRedirect, vrpn_Connection
+#include "vrpn_Shared.h"     // for timeval, vrpn_vector
+#include "vrpn_Types.h"      // for vrpn_uint32, vrpn_int32
+
+class vrpn_MainloopContainer;
+class vrpn_DeviceWorker;
+struct vrpn_DeviceQueue;
+
+class VRPN_API vrpn_DeviceScheduler : public vrpn_MessageRedirect {
+public:
+    /// Schedule devices that use connection.  Each worker can queue up to
+    /// queue_bytes of messages while mainloop() has not taken its last
+    /// batch; messages that do not fit are dropped and counted.
+    vrpn_DeviceScheduler(vrpn_Connection *connection,
+                         vrpn_uint32 queue_bytes = 1024 * 1024);
+
+    /// Stops the workers.  Does not touch the devices.
+    virtual ~vrpn_DeviceScheduler(void);
+
+    /// Hands the devices in container out to num_threads workers in turn
+    /// (fewer if there are fewer devices) and starts them.  Each worker
+    /// sleeps sleep_msecs between passes over its devices; 0 (or less)
+    /// only gives up the processor for a moment.
+    /// The container must outlive the workers.  Returns false, with no
+    /// worker running, if threads are not available or cannot be started;
+    /// the caller should then run the devices itself.
+    bool start(vrpn_MainloopContainer &container, unsigned num_threads,
+               int sleep_msecs = 1);
+
+    /// Stops the workers after their current pass and hands anything they
+    /// queued to the connection.  After this the caller may run or delete
+    /// the devices itself.  Must not be called from a message handler.
+    void stop(void);
+
+    bool running(void) const { return !d_workers.empty(); }
+    unsigned thread_count(void) const
+    {
+        return static_cast<unsigned>(d_workers.size());
+    }
+
+    /// Call each time through the program's main loop, from the thread
+    /// that owns the connection, instead of the connection's mainloop().
+    /// Returns what the connection's mainloop() does.
+    int mainloop(const struct timeval *timeout = NULL);
+
+    /// Wait for every worker to finish its current pass and hold them all
+    /// until resume_devices().  The connection calls these around each
+    /// dispatch of a message to its handlers.  Calls must pair up and must
+    /// not nest.  Does nothing when called from a worker.
+    /// @{
+    virtual void pause_devices(void);
+    virtual void resume_devices(void);
+    /// @}
+
+    /// Number of messages dropped because a worker's queue was full.
+    vrpn_uint32 messages_dropped(void) const { return d_dropped; }
+
+    /// @name vrpn_MessageRedirect
+    /// Queue the messages packed on a worker.
+    /// @{
+    virtual bool redirecting(void);
+    virtual int redirect_message(vrpn_uint32 len, struct timeval time,
+                                 vrpn_int32 type, vrpn_int32 sender,
+                                 const char *buffer,
+                                 vrpn_uint32 class_of_service);
+    virtual char *redirect_reserve(vrpn_uint32 max_len);
+    virtual int redirect_commit(vrpn_uint32 len, struct timeval time,
+                                vrpn_int32 type, vrpn_int32 sender,
+                                vrpn_uint32 class_of_service);
+    /// @}
+
+protected:
+    vrpn_Connection *d_connection;
+    vrpn_uint32 d_queueBytes;
+    vrpn_vector<vrpn_DeviceWorker *> d_workers;
+    vrpn_uint32 d_dropped; ///< Counted as queues are emptied
+
+    /// Pack the batch a worker has handed over into the connection, and
+    /// everything else it queued if its thread has stopped.
+    void drain(vrpn_DeviceWorker *worker);
+    void pack(vrpn_DeviceQueue &queue);
+    void destroy_workers(void);
+
+private:
+    // Not copyable
+    vrpn_DeviceScheduler(const vrpn_DeviceScheduler &);
+    vrpn_DeviceScheduler &operator=(const vrpn_DeviceScheduler &);
+};
+
+#endif
@@ -54,6 +54,9 @@ public:
                              vrpn_float64 update_rate = 10.0);
     virtual void mainloop();
 
+    /// Only needs to run when the next report is due.
+    virtual vrpn_int32 max_wait_usecs(void);
+
 protected:
     vrpn_float64 _spin_rate;   // The rate at which to spin (revolutions/sec)
     vrpn_float64 _update_rate; // The rate at which to update (reports/sec)
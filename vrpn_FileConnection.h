@@ -70,6 +70,19 @@ extern VRPN_API bool vrpn_FILE_CONNECTIONS_SHOULD_ACCUMULATE;
 
 extern VRPN_API bool vrpn_FILE_CONNECTIONS_SHOULD_SKIP_TO_USER_MESSAGES;
 
+// Global variable used to indicate whether File Connections should map
+// the whole log file into memory and play messages straight out of the
+// mapping, rather than reading them into buffers.  Nothing is allocated
+// per message, so even very large files open immediately; this takes the
+// place of preloading and accumulating.  Payloads handed to callbacks
+// point into the file and are not aligned, so handlers must read them
+// with vrpn_unbuffer() rather than by casting.  Where files cannot be
+// mapped, the File Connection quietly reads them as usual.  This defaults
+// to "false".  The value is only checked at connection creation time;
+// the connection behaves consistently once created.
+
+extern VRPN_API bool vrpn_FILE_CONNECTIONS_SHOULD_MMAP;
+
 class VRPN_API vrpn_File_Connection : public vrpn_Connection {
 public:
     vrpn_File_Connection(const char *station_name,
@@ -283,6 +296,51 @@ protected:
 
     virtual int close_file(void);
 
+    // }}}
+    // {{{ memory-mapped replay
+    //     When the file is mapped, d_logHead, d_logTail and
+    //     d_currentLogEntry all point at d_mappedEntry, which read_entry()
+    //     fills in from the entry at d_mapNext with its buffer pointing
+    //     into the mapping.  Preloading and accumulating are turned off.
+protected:
+    const char *d_mapBase;      // start of the mapped file; NULL if not mapped
+    size_t d_mapSize;           // length of the mapping
+    size_t d_mapNext;           // offset of the next entry to read
+    size_t d_mapCurrent;        // offset of the entry in d_mappedEntry
+    vrpn_LOGLIST d_mappedEntry; // the one entry we have "in memory"
+
+    bool map_file(void);
+    int read_mapped_entry(void); // returns 0 on success, 1 on EOF
+    bool parse_mapped_header(size_t offset, vrpn_HANDLERPARAM &header);
+
+    // }}}
+    // {{{ time index for jump_to_time
+    //     Built the first time jump_to_time() has to go backwards, when
+    //     entries can be found again by pointer (preload) or file offset
+    //     (mapped, or not accumulating).  Every so many entries it notes
+    //     where the entry is, the latest time of any entry before it and
+    //     which sender and type descriptions are in effect there, so a
+    //     seek is a binary search, replaying those descriptions and a
+    //     short skip forward, however long the file.
+protected:
+    struct vrpn_FileIndexEntry {
+        timeval maxTime;        // latest time of any entry before this one
+        vrpn_LOGLIST *entry;    // the entry itself, when preloaded
+        long offset;            // where the entry starts in the file
+        vrpn_uint32 firstDescription; // d_descriptions[first, end) are
+        vrpn_uint32 endDescription;   // in effect at this entry
+    };
+    vrpn_vector<vrpn_FileIndexEntry> d_index;
+    vrpn_vector<vrpn_HANDLERPARAM> d_descriptions; // copies, in file order
+    bool d_indexBuilt;
+
+    bool build_index(void);
+    void index_entry(const vrpn_HANDLERPARAM &header, vrpn_LOGLIST *entry,
+                     long offset, vrpn_uint32 &count, timeval &maxTime,
+                     vrpn_uint32 &firstDescription);
+    int seek_with_index(timeval filetime);
+    int apply_description(const vrpn_HANDLERPARAM &header);
+
     // }}}
     // {{{ handlers for VRPN control messages that might come from
     //     a File Controller object that wants to control this
@@ -51,6 +51,13 @@ const unsigned vrpn_IMAGER_MAX_REGIONf32 =
     - 6 * sizeof(vrpn_int32)) /     // VRPN message header
     sizeof(vrpn_float32);
 
+/// How many bytes of values go in each fragment of a bulk region (see
+/// vrpn_Imager_Server::send_bulk_region()).
+const unsigned vrpn_IMAGER_MAX_FRAGMENT =
+    vrpn_CONNECTION_TCP_BUFLEN
+    - 2 * sizeof(vrpn_int32)        // fragment header size
+    - 6 * sizeof(vrpn_int32);       // VRPN message header
+
 /// Holds the description needed to convert from raw data to values for a
 /// channel
 class VRPN_API vrpn_Imager_Channel {
@@ -69,6 +76,17 @@ public:
         d_compression = NONE;
     };
 
+    /// How the values in regions of the channel are sent.  All of them are
+    /// lossless.  The server only compresses while every remote connected
+    /// to it has said that it can decode them, so remotes from before they
+    /// were added still get the values as they are.
+    typedef enum {
+        NONE = 0,    //< Values as they are
+        LZ = 1,      //< LZ77-coded bytes; good for masks and label images
+        DELTA_LZ = 2 //< Differences along rows, split into byte planes and
+                     // then LZ77-coded; good for camera and depth images
+    } ChannelCompression;
+
     vrpn_CNAME name;  //< Name of the data set stored in this channel
     vrpn_CNAME units; //< Units for the data set stored in this channel
     vrpn_float32 minVal,
@@ -112,10 +130,44 @@ protected:
         }
     }
 
-    typedef enum { NONE = 0 } ChannelCompression;
     ChannelCompression d_compression;
 };
 
+/// Compresses and decompresses the values of regions for channels that
+/// call for it (see vrpn_Imager_Channel::ChannelCompression), keeping the
+/// space it works in from one region to the next.  A coded block starts
+/// with a byte telling whether the rest is LZ77-coded or, when coding
+/// would not make it smaller, the values as they are, so it is never
+/// more than one byte larger than the values.
+class VRPN_API vrpn_Imager_Codec {
+public:
+    /// Codes bytes bytes of values, elemSize bytes each in rows of cols
+    /// values, with the given compression.  Returns a pointer to the coded
+    /// block, which stays valid until the next call, and its size in
+    /// codedBytes; or NULL if there is not enough memory.
+    const char *encode(vrpn_Imager_Channel::ChannelCompression compression,
+                       const char *values, vrpn_uint32 bytes,
+                       unsigned elemSize, vrpn_uint32 cols,
+                       vrpn_uint32 &codedBytes);
+
+    /// The most bytes of values that a block of codedBytes can decode to,
+    /// so that a receiver need not make room for more than that.
+    static vrpn_uint32 max_decoded_bytes(vrpn_uint32 codedBytes);
+
+    /// Decodes a block coded by encode() with the same parameters into
+    /// bytes bytes of values.  Returns false if the block is not valid.
+    bool decode(vrpn_Imager_Channel::ChannelCompression compression,
+                const char *coded, vrpn_uint32 codedBytes, char *values,
+                vrpn_uint32 bytes, unsigned elemSize, vrpn_uint32 cols);
+
+protected:
+    vrpn_vector<char> d_planes;        //< Values split into byte planes
+    vrpn_vector<char> d_coded;         //< The coded block
+    vrpn_vector<vrpn_uint32> d_recent; //< Where 4-byte strings were last seen
+
+    bool make_room(vrpn_vector<char> &buffer, vrpn_uint32 bytes);
+};
+
 /// Base class for Imager class
 class VRPN_API vrpn_Imager : public vrpn_BaseClass {
 public:
@@ -154,6 +206,14 @@ protected:
     // with 16-bit unsigned entries
     vrpn_int32 d_regionf32_m_id; //< ID of the message type describing a region
                                  // with 32-bit float entries
+    vrpn_int32 d_bulk_region_m_id; //< ID of the message type describing a
+    // region whose values follow in fragments
+    vrpn_int32 d_bulk_fragment_m_id; //< ID of the message type holding part
+    // of the values of a bulk region
+    vrpn_int32 d_bulk_request_m_id; //< ID of the message type saying that a
+    // client understands bulk regions
+    vrpn_int32 d_compression_request_m_id; //< ID of the message type saying
+    // that a client can decode compressed channels
 };
 
 class VRPN_API vrpn_Imager_Server : public vrpn_Imager {
@@ -247,6 +307,35 @@ public:
         vrpn_uint16 dMin = 0, vrpn_uint16 dMax = 0,
         const struct timeval *time = NULL);
 
+    /// Send a region of any size, up to a whole frame, as one bulk region: a
+    /// description of the region followed by its values in as many
+    /// fragments as it takes, which the remote puts back together and hands
+    /// to its region handlers as one region.  data holds the values of the
+    /// region packed together, with columns varying fastest, then rows,
+    /// then depth.  Clients that do not understand bulk regions get the
+    /// values as ordinary region messages instead.
+    bool send_bulk_region(vrpn_int16 chanIndex, vrpn_uint16 cMin,
+                          vrpn_uint16 cMax, vrpn_uint16 rMin, vrpn_uint16 rMax,
+                          const vrpn_uint8 *data, vrpn_uint16 dMin = 0,
+                          vrpn_uint16 dMax = 0,
+                          const struct timeval *time = NULL);
+    bool send_bulk_region(vrpn_int16 chanIndex, vrpn_uint16 cMin,
+                          vrpn_uint16 cMax, vrpn_uint16 rMin, vrpn_uint16 rMax,
+                          const vrpn_uint16 *data, vrpn_uint16 dMin = 0,
+                          vrpn_uint16 dMax = 0,
+                          const struct timeval *time = NULL);
+    bool send_bulk_region(vrpn_int16 chanIndex, vrpn_uint16 cMin,
+                          vrpn_uint16 cMax, vrpn_uint16 rMin, vrpn_uint16 rMax,
+                          const vrpn_float32 *data, vrpn_uint16 dMin = 0,
+                          vrpn_uint16 dMax = 0,
+                          const struct timeval *time = NULL);
+
+    /// Set how the values of a channel's regions are sent; NONE by default.
+    /// Returns true on success.
+    bool set_channel_compression(
+        vrpn_int16 chanIndex,
+        vrpn_Imager_Channel::ChannelCompression compression);
+
     /// Set the resolution to a different value than it had been before.
     /// Returns true on success.
     bool set_resolution(vrpn_int32 nCols, vrpn_int32 nRows,
@@ -266,6 +355,45 @@ protected:
     // dropping
     vrpn_uint16 d_dropped_due_to_throttle; //< Number of frames dropped due to
     // the throttle request
+    vrpn_int32 d_bulk_id; //< Number of the last bulk region sent
+    vrpn_Imager_Codec d_codec; //< Compresses regions for channels that ask
+    bool d_compressing; //< Did the last description sent say compressed?
+
+    /// True if every connected remote can decode compressed channels.
+    bool peers_can_decode(void) const;
+
+    /// Replaces the values packed from values up to *msgbuf in a region
+    /// message with their coding for the channel, moving *msgbuf and
+    /// *buflen to match.  Returns false if they cannot be coded.
+    bool compress_region_values(vrpn_int16 chanIndex, char *values,
+                                char **msgbuf, int *buflen, unsigned elemSize,
+                                vrpn_uint32 cols);
+
+    /// Checks the channel and the region's bounds, printing what is wrong
+    /// on behalf of caller if they are not valid.
+    bool check_region(const char *caller, vrpn_int16 chanIndex,
+                      vrpn_uint16 cMin, vrpn_uint16 cMax, vrpn_uint16 rMin,
+                      vrpn_uint16 rMax, vrpn_uint16 dMin,
+                      vrpn_uint16 dMax) const;
+
+    /// What the send_bulk_region() overloads all do: values of valType go
+    /// out as a bulk region or, to clients that do not understand those,
+    /// as region messages of up to maxVals values.
+    template <class T>
+    bool send_bulk_region_of(vrpn_int16 chanIndex, vrpn_uint16 cMin,
+                             vrpn_uint16 cMax, vrpn_uint16 rMin,
+                             vrpn_uint16 rMax, const T *data, vrpn_uint16 dMin,
+                             vrpn_uint16 dMax, const struct timeval *time,
+                             vrpn_uint16 valType, unsigned maxVals);
+
+    /// Sends the description and fragments of a bulk region whose bounds
+    /// have been checked.  data holds bytes bytes of values of valType.
+    bool send_bulk_fragments(vrpn_int16 chanIndex, vrpn_uint16 cMin,
+                             vrpn_uint16 cMax, vrpn_uint16 rMin,
+                             vrpn_uint16 rMax, vrpn_uint16 dMin,
+                             vrpn_uint16 dMax, vrpn_uint16 valType,
+                             const char *data, vrpn_uint32 bytes,
+                             const struct timeval *time);
 
     // This method makes sure we send a description whenever we get a ping from
     // a client object.
@@ -729,8 +857,54 @@ public:
     /// have we gotten a description message yet?
     bool is_description_valid() { return d_got_description; }
 
+    /// Have the values of bulk regions put into buffer, which holds bytes
+    /// bytes, as their fragments arrive, rather than into space the remote
+    /// allocates, when they fit.  The region handed to the region handlers
+    /// then points into buffer, and the values stay there until the next
+    /// bulk region starts to arrive.  Pass NULL to go back to the remote's
+    /// own space.
+    void set_bulk_buffer(void *buffer, vrpn_uint32 bytes)
+    {
+        d_user_bulk_buffer = static_cast<char *>(buffer);
+        d_user_bulk_bytes = buffer ? bytes : 0;
+    }
+
+    /// Whether to ask the server for bulk regions when connecting (the
+    /// default).  Set this to false before the first call to mainloop() to
+    /// get large regions as ordinary region messages, for example to pass
+    /// them on to clients that may not understand bulk regions.
+    void set_accept_bulk_regions(bool accept) { d_accept_bulk = accept; }
+
+    /// Whether to tell the server when connecting that we can decode
+    /// compressed channels (the default).  Set this to false before the
+    /// first call to mainloop() to keep the server from compressing, for
+    /// example to pass its messages on to clients that may not decode them.
+    void set_accept_compression(bool accept) { d_accept_compression = accept; }
+
 protected:
     bool d_got_description; //< Have we gotten a description yet?
+    bool d_accept_bulk;     //< Ask for bulk regions when connecting?
+    bool d_accept_compression; //< Say we decode them when connecting?
+    bool d_requests_due;    //< Connected before our first mainloop()?
+
+    // The bulk region whose fragments are arriving
+    vrpn_int32 d_bulk_id;             //< Its number, -1 if there is none
+    vrpn_Imager_Region d_bulk_region; //< What it covers
+    struct timeval d_bulk_time;       //< When it was sent
+    vrpn_uint32 d_bulk_bytes;         //< How many bytes of values it has
+    vrpn_uint32 d_bulk_received;      //< How many have arrived so far
+    char *d_bulk_values;              //< Where they are put
+    vrpn_vector<vrpn_float64> d_own_bulk_buffer; //< Our space for them
+    char *d_user_bulk_buffer;         //< Caller's space for them, if any
+    vrpn_uint32 d_user_bulk_bytes;    //< Size of the caller's space
+    char *d_bulk_coded;               //< Where its fragments are put
+    vrpn_vector<char> d_own_coded_buffer; //< Our space for them if coded
+    vrpn_uint32 d_bulk_values_bytes;  //< Size of the values once decoded
+
+    // Values of compressed regions, decoded for the region handlers
+    vrpn_Imager_Codec d_codec;
+    vrpn_vector<vrpn_float64> d_decoded;
+
     // Lists to keep track of registered user handlers.
     vrpn_Callback_List<struct timeval> d_description_list;
     vrpn_Callback_List<vrpn_IMAGERREGIONCB> d_region_list;
@@ -761,6 +935,24 @@ protected:
     /// Handler for discarded-frames message from the server.
     static int VRPN_CALLBACK
     handle_discarded_frames_message(void *userdata, vrpn_HANDLERPARAM p);
+
+    /// Handlers for the description and the fragments of a bulk region.
+    /// @{
+    static int VRPN_CALLBACK
+    handle_bulk_region_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_bulk_fragment_message(void *userdata, vrpn_HANDLERPARAM p);
+    /// @}
+
+    /// Tell the server we understand bulk regions and compressed channels,
+    /// unless told not to, when we connect.
+    static int VRPN_CALLBACK
+    handle_connection_made(void *userdata, vrpn_HANDLERPARAM p);
+    void send_requests(void);
+
+    /// True if the region is for one of the described channels and lies
+    /// within the described image.
+    bool region_in_image(const vrpn_Imager_Region &reg) const;
 };
 
 //------------------------------------------------------------------------------
@@ -1,6 +1,8 @@
 #ifndef VRPN_LOG_H
 #define VRPN_LOG_H
 
+class vrpn_LogWriter;
+
 /**
  * @class vrpn_Log
  * Logs a VRPN stream.
@@ -67,10 +69,26 @@ public:
     timeval lastLogTime();
     ///< Returns the time of the last message that was logged
 
+    int setStreaming(vrpn_uint32 bufferBytes, vrpn_uint32 flushMsecs);
+    ///< Instead of keeping messages in memory until saveLogSoFar() or
+    ///< close(), queue them in a ring of bufferBytes that a writer thread
+    ///< empties to the file in large blocks, flushing it at least every
+    ///< flushMsecs.  Messages that don't fit in the ring are dropped and
+    ///< counted.  Zero bytes goes back to keeping messages in memory.
+    ///< Without threads, messages are written to the file as they arrive.
+
+    vrpn_uint32 droppedEntries(void) const { return d_droppedEntries; }
+    ///< Number of messages dropped because the writer fell behind.
+
 protected:
     int checkFilters(vrpn_int32 payloadLen, struct timeval time,
                      vrpn_int32 type, vrpn_int32 sender, const char* buffer);
 
+    int streamMessage(vrpn_int32 payloadLen, struct timeval time,
+                      vrpn_int32 type, vrpn_int32 sender, const char* buffer);
+    int startStreaming(void);
+    int stopStreaming(void);
+
     char* d_logFileName;
     long d_logmode;
 
@@ -89,6 +107,12 @@ protected:
     vrpn_TranslationTable* d_types;
 
     timeval d_lastLogTime;
+
+    vrpn_uint32 d_streamBytes; ///< Ring size when streaming, else 0
+    vrpn_uint32 d_streamFlushMsecs;
+    vrpn_bool d_streaming;     ///< Streaming has started on d_file
+    vrpn_LogWriter* d_writer;  ///< NULL when writing without a thread
+    vrpn_uint32 d_droppedEntries;
 };
 
 #endif // VRPN_LOG_H
@@ -56,6 +56,17 @@ public:
     /// that they were added.
     void mainloop();
 
+    /// Adds the descriptors every object's mainloop() waits on to fds and
+    /// returns the shortest of their max_wait_usecs(), or -1 if none of
+    /// them has a limit.
+    vrpn_int32 get_wait(vrpn_vector<int> &fds);
+
+    /// Number of objects held.
+    size_t size() const { return _vrpn.size(); }
+
+    /// The object at index (0 to size()-1), in the order they were added.
+    vrpn_MainloopObject *get(size_t index) const { return _vrpn[index]; }
+
 private:
     vrpn_vector<vrpn_MainloopObject *> _vrpn;
 };
@@ -103,6 +114,20 @@ inline void vrpn_MainloopContainer::clear()
     _vrpn.clear();
 }
 
+inline vrpn_int32 vrpn_MainloopContainer::get_wait(vrpn_vector<int> &fds)
+{
+    vrpn_int32 shortest = -1;
+    const size_t n = _vrpn.size();
+    for (size_t i = 0; i < n; ++i) {
+        _vrpn[i]->get_wait_descriptors(fds);
+        vrpn_int32 usecs = _vrpn[i]->max_wait_usecs();
+        if ((usecs >= 0) && ((shortest < 0) || (usecs < shortest))) {
+            shortest = usecs;
+        }
+    }
+    return shortest;
+}
+
 inline void vrpn_MainloopContainer::mainloop()
 {
     const size_t n = _vrpn.size();
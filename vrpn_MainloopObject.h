@@ -61,6 +61,11 @@ public:
     /// NULL.
     virtual bool broken() = 0;
 
+    /// What mainloop() waits for, as in
+    /// vrpn_BaseClassUnique::get_wait_descriptors() and max_wait_usecs().
+    virtual void get_wait_descriptors(vrpn_vector<int> & /*fds*/) {}
+    virtual vrpn_int32 max_wait_usecs() { return 1000; }
+
     /// Templated wrapping function
     template <class T> static vrpn_MainloopObject *wrap(T o);
 
@@ -136,6 +141,16 @@ namespace detail {
 
         virtual bool broken() { return (_instance->connectionPtr() == NULL); }
 
+        virtual void get_wait_descriptors(vrpn_vector<int> &fds)
+        {
+            _instance->get_wait_descriptors(fds);
+        }
+
+        virtual vrpn_int32 max_wait_usecs()
+        {
+            return _instance->max_wait_usecs();
+        }
+
     protected:
         virtual void *_returnContained() const { return _instance; }
         T *_instance;
@@ -20,6 +20,7 @@
 
 // Internal Includes
 #include <quat.h>
+#include "vrpn_Shared.h" // for vrpn_vector
 
 // Library/third-party includes
 // - none
@@ -240,4 +241,349 @@ class vrpn_QuatFilterable {
 
 typedef vrpn_OneEuroFilter<vrpn_QuatFilterable> vrpn_OneEuroFilterQuat;
 
+// The quaternion steps of vrpn_OneEuroFilterBank, each done for count
+// quaternions held one array per component.  Doubles go to the quatlib
+// batch routines, which use SSE2 or AVX where the CPU has them; other
+// scalar types are done one at a time.
+template<typename Scalar>
+class vrpn_OneEuroBankQuatOps {
+	public:
+		static void mult(int count, Scalar * const dest[4], Scalar * const left[4], Scalar * const right[4]) {
+			for (int j = 0; j < count; ++j) {
+				Scalar lx = left[Q_X][j], ly = left[Q_Y][j], lz = left[Q_Z][j], lw = left[Q_W][j];
+				Scalar rx = right[Q_X][j], ry = right[Q_Y][j], rz = right[Q_Z][j], rw = right[Q_W][j];
+				dest[Q_W][j] = lw * rw - lx * rx - ly * ry - lz * rz;
+				dest[Q_X][j] = lw * rx + lx * rw + ly * rz - lz * ry;
+				dest[Q_Y][j] = lw * ry + ly * rw + lz * rx - lx * rz;
+				dest[Q_Z][j] = lw * rz + lz * rw + lx * ry - ly * rx;
+			}
+		}
+
+		static void slerp(int count, Scalar * const dest[4], Scalar * const start[4], Scalar * const end[4], const Scalar *t) {
+			for (int j = 0; j < count; ++j) {
+				Scalar cosOmega = start[Q_X][j] * end[Q_X][j] + start[Q_Y][j] * end[Q_Y][j] +
+					start[Q_Z][j] * end[Q_Z][j] + start[Q_W][j] * end[Q_W][j];
+				Scalar sign = 1;
+				if (cosOmega < 0) {
+					cosOmega = -cosOmega;
+					sign = -1;
+				}
+				Scalar startScale, endScale;
+				if ((1 - cosOmega) > Q_EPSILON) {
+					Scalar omega = acos(cosOmega);
+					Scalar sinOmega = sin(omega);
+					startScale = sin((1 - t[j]) * omega) / sinOmega;
+					endScale = sin(t[j] * omega) / sinOmega;
+				} else {
+					startScale = 1 - t[j];
+					endScale = t[j];
+				}
+				startScale *= sign;
+				for (int k = 0; k < 4; ++k) {
+					dest[k][j] = startScale * start[k][j] + endScale * end[k][j];
+				}
+			}
+		}
+
+		static void normalize(int count, Scalar * const dest[4], Scalar * const src[4]) {
+			for (int j = 0; j < count; ++j) {
+				Scalar factor = 1 / sqrt(src[Q_X][j] * src[Q_X][j] + src[Q_Y][j] * src[Q_Y][j] +
+					src[Q_Z][j] * src[Q_Z][j] + src[Q_W][j] * src[Q_W][j]);
+				for (int k = 0; k < 4; ++k) {
+					dest[k][j] = src[k][j] * factor;
+				}
+			}
+		}
+};
+
+template<>
+class vrpn_OneEuroBankQuatOps<double> {
+	public:
+		static void mult(int count, double * const dest[4], double * const left[4], double * const right[4]) {
+			q_batch_type d = batch(dest), l = batch(left), r = batch(right);
+			q_batch_mult(&d, &l, &r, count);
+		}
+
+		static void slerp(int count, double * const dest[4], double * const start[4], double * const end[4], const double *t) {
+			q_batch_type d = batch(dest), s = batch(start), e = batch(end);
+			q_batch_slerp(&d, &s, &e, t, count);
+		}
+
+		static void normalize(int count, double * const dest[4], double * const src[4]) {
+			q_batch_type d = batch(dest), s = batch(src);
+			q_batch_normalize(&d, &s, count);
+		}
+
+	private:
+		static q_batch_type batch(double * const rows[4]) {
+			q_batch_type b;
+			b.x = rows[Q_X];
+			b.y = rows[Q_Y];
+			b.z = rows[Q_Z];
+			b.w = rows[Q_W];
+			return b;
+		}
+};
+
+// Where vrpn_OneEuroFilterBank keeps its arrays: ROWS arrays of one entry
+// per sensor.  With SENSORS fixed they are part of the object; with
+// SENSORS 0 they are allocated for the count given when it is built.
+template<int SENSORS, int ROWS, typename Scalar>
+class vrpn_OneEuroBankStorage {
+	public:
+		explicit vrpn_OneEuroBankStorage(int) {
+			memset(_data, 0, sizeof(_data));
+		}
+		int sensors() const {
+			return SENSORS;
+		}
+		Scalar *row(int r) {
+			return _data + r * SENSORS;
+		}
+
+	private:
+		Scalar _data[ROWS * SENSORS];
+};
+
+template<int ROWS, typename Scalar>
+class vrpn_OneEuroBankStorage<0, ROWS, Scalar> {
+	public:
+		explicit vrpn_OneEuroBankStorage(int sensors) : _sensors(sensors > 0 ? sensors : 0) {
+			_data.assign(ROWS * _sensors, Scalar(0));
+		}
+		int sensors() const {
+			return _sensors;
+		}
+		Scalar *row(int r) {
+			return _data.data() + r * _sensors;
+		}
+
+	private:
+		int _sensors;
+		vrpn_vector<Scalar> _data;
+};
 
+/// @brief A bank of one-Euro filters for the positions and orientations of
+/// many sensors, which filters a whole frame of them in one pass.
+///
+/// It gives the same answers as a vrpn_OneEuroFilterVec and a
+/// vrpn_OneEuroFilterQuat for each sensor, but keeps the state of all of
+/// them struct-of-arrays (all of the sensors' X positions together, and so
+/// on), so each step of the filter, including working out the alphas, is
+/// one loop over the sensors that the compiler can vectorize, and the
+/// quaternion steps use the quatlib batch routines.  SENSORS is how many
+/// sensors it filters, or 0 to give that to the constructor instead.
+template<int SENSORS = 0, typename Scalar = vrpn_float64>
+class vrpn_OneEuroFilterBank {
+	public:
+		typedef Scalar scalar_type;
+		typedef Scalar vec_type[3];
+		typedef Scalar quat_type[4];
+
+		explicit vrpn_OneEuroFilterBank(int sensors = SENSORS) :
+			_store(sensors),
+			_vecMinCutoff(1), _vecBeta(0.5), _vecDerivativeCutoff(1),
+			_quatMinCutoff(1), _quatBeta(0.5), _quatDerivativeCutoff(1) {
+			reset();
+		}
+
+		int sensors() const {
+			return _store.sensors();
+		}
+
+		void setVecParams(scalar_type mincutoff, scalar_type beta, scalar_type dcutoff) {
+			_vecMinCutoff = mincutoff;
+			_vecBeta = beta;
+			_vecDerivativeCutoff = dcutoff;
+		}
+		void setQuatParams(scalar_type mincutoff, scalar_type beta, scalar_type dcutoff) {
+			_quatMinCutoff = mincutoff;
+			_quatBeta = beta;
+			_quatDerivativeCutoff = dcutoff;
+		}
+
+		/// Start all sensors over, or just one; the next report for each is
+		/// passed through and starts its filter.
+		void reset() {
+			Scalar *first = _store.row(FIRST);
+			for (int i = 0; i < sensors(); ++i) {
+				first[i] = 1;
+			}
+		}
+		void reset(int sensor) {
+			_store.row(FIRST)[sensor] = 1;
+		}
+
+		/// Filter the reports from count sensors.  which lists them (each
+		/// at most once, all less than sensors()), or is NULL for
+		/// sensors 0 through count-1.  dt[j] is the time since sensor j's
+		/// last report, in seconds; zero or less is taken as one second.
+		/// The filtered position goes in outPos[j] and the filtered,
+		/// normalized orientation in outQuat[j]; these may be the same
+		/// arrays as pos and quat.
+		void filter(int count, const vrpn_int32 *which, const scalar_type *dt,
+				const vec_type *pos, const quat_type *quat,
+				vec_type *outPos, quat_type *outQuat) {
+			int j, k;
+			if (count > sensors()) {
+				count = sensors();
+			}
+
+			// Work directly on the state when it's sensors 0 through
+			// count-1, otherwise on a copy of the state of those asked for.
+			Scalar *hx[3], *hdx[3], *hq[4], *hdq[4], *first;
+			Scalar *x[3], *dx[3], *q[4], *dq[4], *inv[4];
+			for (k = 0; k < 3; ++k) {
+				x[k] = _store.row(X + k);
+				dx[k] = _store.row(DX + k);
+			}
+			for (k = 0; k < 4; ++k) {
+				q[k] = _store.row(Q + k);
+				dq[k] = _store.row(DQ + k);
+				inv[k] = _store.row(INV + k);
+			}
+			Scalar *d = _store.row(DT);
+			Scalar *mag = _store.row(MAG);
+			Scalar *alpha = _store.row(ALPHA);
+			int state = which ? WORK : STATE;
+			for (k = 0; k < 3; ++k) {
+				hx[k] = _store.row(state + HX + k);
+				hdx[k] = _store.row(state + HDX + k);
+			}
+			for (k = 0; k < 4; ++k) {
+				hq[k] = _store.row(state + HQ + k);
+				hdq[k] = _store.row(state + HDQ + k);
+			}
+			first = _store.row(state + FIRST);
+			if (which) {
+				for (int r = 0; r < STATE_ROWS; ++r) {
+					Scalar *from = _store.row(STATE + r);
+					Scalar *to = _store.row(WORK + r);
+					for (j = 0; j < count; ++j) {
+						to[j] = from[which[j]];
+					}
+				}
+			}
+
+			// Take the reports apart into one array per component, and start
+			// the filters of sensors we haven't heard from: with the previous
+			// value set to the new one, the derivative comes out as none and
+			// the new value passes straight through.
+			for (j = 0; j < count; ++j) {
+				d[j] = dt[j] > 0 ? dt[j] : 1;
+				for (k = 0; k < 3; ++k) {
+					x[k][j] = pos[j][k];
+				}
+				for (k = 0; k < 4; ++k) {
+					q[k][j] = quat[j][k];
+				}
+				if (first[j] != 0) {
+					first[j] = 0;
+					for (k = 0; k < 3; ++k) {
+						hx[k][j] = x[k][j];
+						hdx[k][j] = 0;
+					}
+					for (k = 0; k < 4; ++k) {
+						hq[k][j] = q[k][j];
+						hdq[k][j] = (k == Q_W) ? 1 : 0;
+					}
+				}
+			}
+
+			// Position: low-pass the derivative, then use its magnitude to
+			// pick the cutoff for the position itself.
+			for (j = 0; j < count; ++j) {
+				alpha[j] = computeAlpha(d[j], _vecDerivativeCutoff);
+			}
+			for (k = 0; k < 3; ++k) {
+				for (j = 0; j < count; ++j) {
+					dx[k][j] = (x[k][j] - hx[k][j]) / d[j];
+					hdx[k][j] = alpha[j] * dx[k][j] + (1 - alpha[j]) * hdx[k][j];
+				}
+			}
+			for (j = 0; j < count; ++j) {
+				mag[j] = sqrt(hdx[0][j] * hdx[0][j] + hdx[1][j] * hdx[1][j] + hdx[2][j] * hdx[2][j]);
+				alpha[j] = computeAlpha(d[j], _vecMinCutoff + _vecBeta * mag[j]);
+			}
+			for (k = 0; k < 3; ++k) {
+				for (j = 0; j < count; ++j) {
+					hx[k][j] = alpha[j] * x[k][j] + (1 - alpha[j]) * hx[k][j];
+				}
+			}
+
+			// Orientation: the same, with the derivative the rotation from
+			// the last filtered orientation scaled to one second (by nlerp,
+			// as vrpn_QuatFilterable does) and slerp for the low-pass.
+			for (j = 0; j < count; ++j) {
+				Scalar norm = hq[Q_X][j] * hq[Q_X][j] + hq[Q_Y][j] * hq[Q_Y][j] +
+					hq[Q_Z][j] * hq[Q_Z][j] + hq[Q_W][j] * hq[Q_W][j];
+				inv[Q_X][j] = -hq[Q_X][j] / norm;
+				inv[Q_Y][j] = -hq[Q_Y][j] / norm;
+				inv[Q_Z][j] = -hq[Q_Z][j] / norm;
+				inv[Q_W][j] = hq[Q_W][j] / norm;
+			}
+			vrpn_OneEuroBankQuatOps<Scalar>::mult(count, dq, q, inv);
+			for (j = 0; j < count; ++j) {
+				Scalar rate = 1 / d[j];
+				dq[Q_X][j] *= rate;
+				dq[Q_Y][j] *= rate;
+				dq[Q_Z][j] *= rate;
+				dq[Q_W][j] = dq[Q_W][j] * rate + (1 - rate);
+			}
+			vrpn_OneEuroBankQuatOps<Scalar>::normalize(count, dq, dq);
+			for (j = 0; j < count; ++j) {
+				alpha[j] = computeAlpha(d[j], _quatDerivativeCutoff);
+			}
+			vrpn_OneEuroBankQuatOps<Scalar>::slerp(count, hdq, hdq, dq, alpha);
+			for (j = 0; j < count; ++j) {
+				Scalar w = hdq[Q_W][j];
+				w = w > 1 ? 1 : (w < -1 ? -1 : w);
+				mag[j] = 2 * acos(w);
+				alpha[j] = computeAlpha(d[j], _quatMinCutoff + _quatBeta * mag[j]);
+			}
+			vrpn_OneEuroBankQuatOps<Scalar>::slerp(count, hq, hq, q, alpha);
+			vrpn_OneEuroBankQuatOps<Scalar>::normalize(count, q, hq);
+
+			// Hand back the results, and put the state of the sensors back
+			// where it came from.
+			for (j = 0; j < count; ++j) {
+				for (k = 0; k < 3; ++k) {
+					outPos[j][k] = hx[k][j];
+				}
+				for (k = 0; k < 4; ++k) {
+					outQuat[j][k] = q[k][j];
+				}
+			}
+			if (which) {
+				for (int r = 0; r < STATE_ROWS; ++r) {
+					Scalar *from = _store.row(WORK + r);
+					Scalar *to = _store.row(STATE + r);
+					for (j = 0; j < count; ++j) {
+						to[which[j]] = from[j];
+					}
+				}
+			}
+		}
+
+	private:
+		// The rows of the arrays: the state of each sensor (starting at
+		// STATE), a copy of that for the sensors being filtered (starting
+		// at WORK) and the working space for one frame.
+		enum {
+			HX = 0, HDX = 3, HQ = 6, HDQ = 10, FIRST = 14, STATE_ROWS = 15,
+			STATE = 0,
+			WORK = STATE + STATE_ROWS,
+			X = WORK + STATE_ROWS, DX = X + 3, Q = DX + 3, DQ = Q + 4,
+			INV = DQ + 4, DT = INV + 4, MAG = DT + 1, ALPHA = MAG + 1,
+			ROWS = ALPHA + 1
+		};
+
+		static scalar_type computeAlpha(scalar_type dt, scalar_type cutoff) {
+			scalar_type tau = scalar_type(1) / (scalar_type(2) * Q_PI * cutoff);
+			return scalar_type(1) / (scalar_type(1) + tau / dt);
+		}
+
+		vrpn_OneEuroBankStorage<SENSORS, ROWS, Scalar> _store;
+		scalar_type _vecMinCutoff, _vecBeta, _vecDerivativeCutoff;
+		scalar_type _quatMinCutoff, _quatBeta, _quatDerivativeCutoff;
+};
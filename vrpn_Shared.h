@@ -607,8 +607,14 @@ public:
     }
   }
   void push_back (const T& val) {
-    resize(m_size + 1);
-    m_data[m_size-1] = val;
+    // Grow the allocation by doubling, so that filling a vector one
+    // element at a time takes amortized constant time per element.
+    if (m_size == m_allocated) {
+      size_type used = m_size;
+      resize(m_allocated ? 2 * m_allocated : 4);
+      m_size = used;
+    }
+    m_data[m_size++] = val;
   }
   T& front() {
     return m_data[0];
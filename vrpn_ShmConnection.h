@@ -0,0 +1,229 @@
+#ifndef VRPN_SHM_CONNECTION_H
+#define VRPN_SHM_CONNECTION_H
+
+// vrpn_Shm_Connection
+//
+// A connection for clients that run on the same host as their server.
+// A server made by vrpn_create_server_connection("shm:name") publishes
+// every message it packs into a POSIX shared-memory segment named
+// "/vrpn_name", and any number of clients made by
+// vrpn_get_connection_by_name("Device@shm:name") read them straight out
+// of that segment, with no system call and no copy through the kernel.
+//
+// The segment holds:
+//   - a table of the server's sender and type descriptions, which only
+//     grows; clients apply new entries before reading messages.
+//   - a downstream ring written only by the server and read by every
+//     client.  The server never waits for readers: a client that falls
+//     more than a ring behind skips ahead to the newest message and
+//     counts an overrun, rather than slowing the server and the other
+//     clients down.
+//   - an upstream ring that all clients write into (claiming space with
+//     a compare-and-swap) and the server drains.  It carries the
+//     messages clients send to the server (pings, requests) after
+//     translating them into the server's sender and type IDs, and tells
+//     the server when clients arrive and leave.  Space claimed by a
+//     client that dies before filling it in is skipped once the server
+//     sees that the client's process is gone.
+//
+// A side waiting in mainloop() for the other to write sleeps on a futex
+// that the writer wakes, so messages are read as soon as they are written
+// without the writer making a system call when no one is waiting.  Where
+// there are no futexes it polls instead.
+//
+// A client that cannot find the segment keeps retrying once a second,
+// and notices within a second when the server goes away, so it behaves
+// like an IP client whose server restarts.  Requires POSIX shared memory
+// and GCC-style atomic builtins; elsewhere "shm:" connections fail to open.
+//
+// The server creates the segment with permissions vrpn_SHM_SEGMENT_MODE
+// (less the process's umask), which by default lets only the user running
+// the server open it, since any process that can open it can read every
+// message and write into the upstream ring.  To let clients run as other
+// users, build with vrpn_SHM_SEGMENT_MODE defined to, say, 0660 and run
+// them in the server's group.
+
+#include "vrpn_Configure.h"  // for VRPN_API, VRPN_CALLBACK
+#include "vrpn_Connection.h" // for vrpn_Endpoint_IP, etc
+#include "vrpn_Shared.h"     // for timeval, vrpn_vector
+#include "vrpn_Types.h"      // for vrpn_int32, vrpn_uint32
+
+#if !defined(_WIN32) && defined(__GNUC__)
+#define vrpn_SHM_AVAILABLE
+#endif
+
+#ifndef vrpn_SHM_SEGMENT_MODE
+#define vrpn_SHM_SEGMENT_MODE 0600
+#endif
+
+struct vrpn_ShmSegment;
+struct vrpn_ShmRecord;
+class VRPN_API vrpn_Shm_Connection;
+
+/// @brief Endpoint that talks to the other side through a shared-memory
+/// segment rather than through sockets.
+///
+/// Derives from vrpn_Endpoint_IP only because that is what endpoint
+/// allocators return; none of its sockets are used.
+/// This will only be used from within the vrpn_Shm_Connection class;  it
+/// should not be instantiated by users or devices.
+
+class VRPN_API vrpn_Endpoint_Shm : public vrpn_Endpoint_IP {
+
+public:
+    vrpn_Endpoint_Shm(vrpn_TypeDispatcher *dispatcher,
+                      vrpn_int32 *connectedEndpointCounter);
+    virtual ~vrpn_Endpoint_Shm(void);
+
+    virtual vrpn_bool doing_okay(void) const;
+
+    /// Create (server) or open (client) the segment called name.
+    /// Returns 0 and sets status to CONNECTED on success, -1 on failure.
+    int attach(const char *name, bool server);
+
+    /// Unmap the segment; a server also removes it.
+    void detach(void);
+
+    /// Reads whatever the other side has written.  Waits up to timeout
+    /// for something to arrive if nothing has.  Sets status to BROKEN if
+    /// the other side has gone away.
+    int mainloop(timeval *timeout);
+
+    /// Log the message and, when attached, write it for the other side.
+    int pack_message(vrpn_uint32 len, struct timeval time, vrpn_int32 type,
+                     vrpn_int32 sender, const char *buffer,
+                     vrpn_uint32 class_of_service);
+
+    /// Copies the payload like any other message does.
+    int pack_shared_message(vrpn_MessageFrame *frame, vrpn_uint32 len,
+                            struct timeval time, vrpn_int32 type,
+                            vrpn_int32 sender, vrpn_uint32 class_of_service);
+
+    /// Messages are visible to the other side as soon as they are packed.
+    int send_pending_reports(void) { return 0; }
+
+    /// There is no cookie exchange; attach() does all of the setup.
+    /// @{
+    int setup_new_connection(void) { return 0; }
+    void poll_for_cookie(const timeval * /*timeout*/ = NULL) {}
+    int finish_new_connection_setup(void) { return 0; }
+    /// @}
+
+    /// Detach from the segment and forget the other side's senders and
+    /// types, leaving the endpoint ready to attach() again.
+    void drop_connection(void);
+
+    void clearBuffers(void) {}
+
+    /// Number of times a client fell a whole ring behind the server and
+    /// had to skip ahead.
+    vrpn_uint32 overruns(void) const { return d_overruns; }
+
+protected:
+    vrpn_ShmSegment *d_segment;
+    size_t d_segmentBytes;
+    char *d_segmentName;
+    bool d_server;
+
+    char *d_downRing; ///< Server to clients, d_downBytes long
+    char *d_upRing;   ///< Clients to server, d_upBytes long
+    vrpn_uint32 d_downBytes;
+    vrpn_uint32 d_upBytes;
+
+    vrpn_uint32 d_downCursor;  ///< Next downstream position to write/read
+    vrpn_uint32 d_upCursor;    ///< Next upstream position to read (server)
+    vrpn_uint32 d_namesRead;   ///< Description entries applied (client)
+    vrpn_uint32 d_overruns;
+
+    timeval d_lastLivenessCheck;
+    timeval d_upStallTime; ///< When an uncommitted upstream record was
+                           ///< last seen to be still claimed
+
+    /// Maps our sender and type IDs to the server's, -1 when the server
+    /// does not have one by that name (client).
+    vrpn_vector<vrpn_int32> d_serverSenders;
+    vrpn_vector<vrpn_int32> d_serverTypes;
+
+    /// Processes of the clients that have said hello (server).
+    vrpn_vector<vrpn_int32> d_clientPids;
+
+    vrpn_Shm_Connection *shm_connection(void);
+
+    int publish_description(vrpn_uint32 len, timeval time, vrpn_int32 type,
+                            vrpn_int32 which, const char *buffer);
+    int read_descriptions(void);
+    int write_downstream(vrpn_uint32 len, timeval time, vrpn_int32 type,
+                         vrpn_int32 sender, const char *buffer);
+    int write_upstream(vrpn_int32 kind, vrpn_uint32 len, timeval time,
+                       vrpn_int32 type, vrpn_int32 sender,
+                       const char *buffer);
+    int read_downstream(void);
+    int read_upstream(void);
+    bool writer_died(vrpn_ShmRecord *record);
+    bool other_side_alive(void);
+    void forget_client(vrpn_int32 pid);
+};
+
+/// @brief Connection that passes messages through shared memory between
+/// a server and clients on the same host.  See the top of
+/// vrpn_ShmConnection.h.
+
+class VRPN_API vrpn_Shm_Connection : public vrpn_Connection {
+
+protected:
+    /// Make a server (server true) or client connection for the segment
+    /// named in cname ("shm:name").  To access this from user code, call
+    /// vrpn_create_server_connection() or vrpn_get_connection_by_name().
+    vrpn_Shm_Connection(const char *cname, bool server,
+                        const char *local_in_logfile_name = NULL,
+                        const char *local_out_logfile_name = NULL);
+
+public:
+    virtual ~vrpn_Shm_Connection(void);
+
+    /// Call each time through program main loop to handle receiving any
+    /// incoming messages.  Returns -1 when the connection to the server
+    /// is dropped (once per drop), 0 otherwise.  The optional argument is
+    /// how long to wait for something to arrive.
+    virtual int mainloop(const struct timeval *timeout = NULL);
+
+    /// A server is connected while it has at least one client.
+    virtual vrpn_bool connected(void) const;
+
+    /// Number of times this client fell a whole ring behind the server and
+    /// skipped ahead, losing the messages in between.
+    vrpn_uint32 overruns(void) const;
+
+protected:
+    friend VRPN_API vrpn_Connection *vrpn_get_connection_by_name(
+        const char *cname, const char *local_in_logfile_name,
+        const char *local_out_logfile_name, const char *remote_in_logfile_name,
+        const char *remote_out_logfile_name, const char *NIC_IPaddress,
+        bool force_connection);
+    friend VRPN_API vrpn_Connection *
+    vrpn_create_server_connection(const char *cname,
+                                  const char *local_in_logfile_name,
+                                  const char *local_out_logfile_name);
+    friend class vrpn_Endpoint_Shm;
+
+    /// @brief Messages are written as they are packed; nothing to send.
+    virtual int send_pending_reports(void) { return 0; }
+
+    static vrpn_Endpoint_IP *allocateEndpoint(vrpn_Connection *,
+                                              vrpn_int32 *connectedEC);
+
+    vrpn_Endpoint_Shm *shm_endpoint(void) const;
+
+    /// Tell local handlers that a client (or, on a client, the server)
+    /// has come or gone.
+    /// @{
+    void connection_made(void);
+    void connection_lost(void);
+    /// @}
+
+    char *d_segmentName; ///< Name passed to shm_open()
+    bool d_server;
+    timeval d_lastAttempt; ///< When a client last tried to attach
+};
+
+#endif
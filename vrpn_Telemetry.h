@@ -0,0 +1,124 @@
+// vrpn_Telemetry.h
+//	Publishes the traffic counts that a vrpn_Connection keeps for each of
+// its endpoints (see vrpn_Connection::set_telemetry()) so that a monitoring
+// client can watch them.  The server sends, every so often, one message
+// per endpoint with its totals and then one per message type that the
+// endpoint has sent or received, naming the type.  Put one in a running
+// server (vrpn_server does with -telemetry) to see which types use the
+// bandwidth, how full the output buffers get, how often packing had to
+// send them early, and how long the handlers for each type take.
+
+#ifndef VRPN_TELEMETRY_H
+#define VRPN_TELEMETRY_H
+
+#include <stddef.h> // for NULL
+
+#include "vrpn_BaseClass.h"  // for vrpn_Callback_List, etc
+#include "vrpn_Configure.h"  // for VRPN_API, VRPN_CALLBACK
+#include "vrpn_Connection.h" // for vrpn_EndpointTelemetry, etc
+#include "vrpn_Shared.h"     // for timeval
+#include "vrpn_Types.h"      // for vrpn_int32, vrpn_float64
+
+class VRPN_API vrpn_Telemetry : public vrpn_BaseClass {
+public:
+    vrpn_Telemetry(const char *name, vrpn_Connection *c = NULL);
+
+protected:
+    vrpn_int32 d_endpoint_m_id; // Totals for one endpoint
+    vrpn_int32 d_type_m_id;     // Counts for one type on one endpoint
+
+    virtual int register_types(void);
+};
+
+//----------------------------------------------------------
+// Server: turns on telemetry for its connection and reports it every
+// interval seconds.
+
+class VRPN_API vrpn_Telemetry_Server : public vrpn_Telemetry {
+public:
+    vrpn_Telemetry_Server(const char *name, vrpn_Connection *c,
+                          vrpn_float64 interval = 1.0);
+
+    /// Turns the connection's telemetry back off.
+    virtual ~vrpn_Telemetry_Server();
+
+    virtual void mainloop();
+
+    /// Only needs to run when the next report is due.
+    virtual vrpn_int32 max_wait_usecs(void);
+
+    /// Send the counts for every endpoint now.  Returns 0 on success,
+    /// -1 on failure.
+    int report(void);
+
+protected:
+    vrpn_float64 d_interval; // Seconds between reports
+    struct timeval d_last_report;
+};
+
+//----------------------------------------------------------
+//************** Users deal with the following *************
+
+// The totals for one endpoint on the server.  Its types table is empty;
+// the counts for each type come in vrpn_TELEMETRYTYPECBs that follow.
+typedef struct _vrpn_TELEMETRYENDPOINTCB {
+    struct timeval msg_time;
+    vrpn_int32 endpoint;      // Index on the server, 0 to num_endpoints-1
+    vrpn_int32 num_endpoints; // How many the server has now
+    const char *host;         // Machine at the other end
+    const vrpn_EndpointTelemetry *telemetry;
+} vrpn_TELEMETRYENDPOINTCB;
+
+// The counts for one message type on one endpoint.
+typedef struct _vrpn_TELEMETRYTYPECB {
+    struct timeval msg_time;
+    vrpn_int32 endpoint;
+    const char *type_name;
+    const vrpn_TypeTelemetry *telemetry;
+} vrpn_TELEMETRYTYPECB;
+
+typedef void(VRPN_CALLBACK *vrpn_TELEMETRYENDPOINTHANDLER)(
+    void *userdata, const vrpn_TELEMETRYENDPOINTCB info);
+typedef void(VRPN_CALLBACK *vrpn_TELEMETRYTYPEHANDLER)(
+    void *userdata, const vrpn_TELEMETRYTYPECB info);
+
+class VRPN_API vrpn_Telemetry_Remote : public vrpn_Telemetry {
+public:
+    vrpn_Telemetry_Remote(const char *name, vrpn_Connection *c = NULL);
+
+    // This routine calls the mainloop of the connection it's on
+    virtual void mainloop();
+
+    virtual int register_endpoint_handler(void *userdata,
+                                          vrpn_TELEMETRYENDPOINTHANDLER handler)
+    {
+        return d_endpoint_list.register_handler(userdata, handler);
+    }
+    virtual int
+    unregister_endpoint_handler(void *userdata,
+                                vrpn_TELEMETRYENDPOINTHANDLER handler)
+    {
+        return d_endpoint_list.unregister_handler(userdata, handler);
+    }
+    virtual int register_type_handler(void *userdata,
+                                      vrpn_TELEMETRYTYPEHANDLER handler)
+    {
+        return d_type_list.register_handler(userdata, handler);
+    }
+    virtual int unregister_type_handler(void *userdata,
+                                        vrpn_TELEMETRYTYPEHANDLER handler)
+    {
+        return d_type_list.unregister_handler(userdata, handler);
+    }
+
+protected:
+    vrpn_Callback_List<vrpn_TELEMETRYENDPOINTCB> d_endpoint_list;
+    vrpn_Callback_List<vrpn_TELEMETRYTYPECB> d_type_list;
+
+    static int VRPN_CALLBACK
+    handle_endpoint_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_type_message(void *userdata, vrpn_HANDLERPARAM p);
+};
+
+#endif
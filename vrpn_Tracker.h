@@ -89,6 +89,8 @@ protected:
     vrpn_int32 update_rate_id;          // ID of update rate message
     vrpn_int32 connection_dropped_m_id; // ID of connection dropped message
     vrpn_int32 reset_origin_m_id;       // ID of reset origin message
+    vrpn_int32 frame_m_id;              // ID of multi-sensor frame message
+    vrpn_int32 frame_request_m_id;      // ID of client-understands-frames msg
 
     // Description of the next report to go out
     vrpn_int32 d_sensor;              // Current sensor
@@ -128,6 +130,30 @@ protected:
 
     int status; // What are we doing?
 
+    // A frame of reports from several sensors measured at the same time,
+    // held as one array per field: for sensor d_frameSensors[i], its
+    // position starts at d_framePos[3*i], its quaternion at
+    // d_frameQuat[4*i], and so on.  Servers fill it in with add_to_frame()
+    // and send it with send_frame(); remotes decode frame messages into it.
+    vrpn_vector<vrpn_int32> d_frameSensors;
+    vrpn_vector<vrpn_float64> d_framePos, d_frameQuat;
+    vrpn_vector<vrpn_float64> d_frameVel, d_frameVelQuat, d_frameVelQuatDt;
+
+    /// Adds the current report (d_sensor, pos and d_quat, along with vel,
+    /// vel_quat and vel_quat_dt) to the frame.  Returns false if out of
+    /// memory.
+    bool add_to_frame(void);
+
+    /// Sends the reports in the frame, all measured at time t, and empties
+    /// it.  They go out as frame messages (as few as will hold them) if
+    /// there is more than one and every client has asked for frames,
+    /// otherwise as a position message
+    /// (followed by a velocity message if with_velocity) per sensor, which
+    /// is what older clients understand.  Leaves the current report set to
+    /// the frame's last sensor.  Returns 0 on success, -1 on failure.
+    int send_frame(const struct timeval &t, bool with_velocity,
+                   vrpn_uint32 class_of_service = vrpn_CONNECTION_LOW_LATENCY);
+
     virtual int register_types(void); //< Called by BaseClass init()
     virtual int encode_to(char *buf); // Encodes the position report
     // Not all trackers will call the velocity and acceleration packers
@@ -136,6 +162,11 @@ protected:
     virtual int encode_tracker2room_to(char *buf); // Encodes the tracker2room
     virtual int encode_unit2sensor_to(char *buf);  // and unit2sensor xforms
     virtual int encode_workspace_to(char *buf);    // Encodes workspace info
+    // Encodes count sensors from the frame, starting with first, returning
+    // -1 if they do not fit in buflen
+    virtual int encode_frame_to(char *buf, vrpn_int32 buflen,
+                                vrpn_int32 first, vrpn_int32 count,
+                                bool with_velocity);
 };
 
 #ifndef VRPN_CLIENT_ONLY
@@ -147,6 +178,9 @@ public:
                         const char *port = "/dev/ttyS1", long baud = 38400);
     virtual ~vrpn_Tracker_Serial();
 
+    /// Wake up when the serial port has input.
+    virtual void get_wait_descriptors(vrpn_vector<int> &fds);
+
 protected:
     char portname[VRPN_TRACKER_BUF_SIZE];
     long baudrate;
@@ -228,6 +262,9 @@ public:
                       vrpn_int32 sensors = 1, vrpn_float64 Hz = 1.0);
     virtual void mainloop();
 
+    /// Only needs to run when the next report is due.
+    virtual vrpn_int32 max_wait_usecs(void);
+
     void setRedundantTransmission(vrpn_RedundantTransmission *);
 
 protected:
@@ -252,6 +289,9 @@ public:
     vrpn_float64 axisZ = 1, vrpn_float64 spinRateHz = 0.5);
   virtual void mainloop();
 
+  /// Only needs to run when the next report is due.
+  virtual vrpn_int32 max_wait_usecs(void);
+
 protected:
   vrpn_float64 update_rate;
   vrpn_float64 x, y, z, spin_rate_Hz;
@@ -294,6 +334,19 @@ public:
         const vrpn_float64 position[3], const vrpn_float64 quaternion[4],
         const vrpn_float64 interval,
         const vrpn_uint32 class_of_service = vrpn_CONNECTION_LOW_LATENCY);
+
+    /// Report the poses of count sensors measured at the same time, as one
+    /// message to clients that understand it.  sensors lists which ones;
+    /// the others hold an entry for each of them.  velocities,
+    /// vel_quaternions and intervals are either all NULL or all given.
+    virtual int report_frame(
+        const vrpn_int32 count, const struct timeval t,
+        const vrpn_int32 *sensors, const vrpn_Tracker_Pos *positions,
+        const vrpn_Tracker_Quat *quaternions,
+        const vrpn_Tracker_Pos *velocities = NULL,
+        const vrpn_Tracker_Quat *vel_quaternions = NULL,
+        const vrpn_float64 *intervals = NULL,
+        const vrpn_uint32 class_of_service = vrpn_CONNECTION_LOW_LATENCY);
 };
 
 //----------------------------------------------------------
@@ -362,6 +415,26 @@ typedef struct _vrpn_TRACKERUNIT2SENSORCB {
 typedef void(VRPN_CALLBACK *vrpn_TRACKERUNIT2SENSORCHANGEHANDLER)(
     void *userdata, const vrpn_TRACKERUNIT2SENSORCB info);
 
+// User routine to handle a frame of reports from several sensors that were
+// measured at the same time.  Frames are also delivered to the position
+// (and velocity) change handlers, one sensor at a time, after this.
+// A frame too large for one message (about 20 sensors when sent
+// unreliably) arrives in parts with the same msg_time, each with a
+// callback of its own.  The arrays are only valid during the callback.
+
+typedef struct _vrpn_TRACKERFRAMECB {
+    struct timeval msg_time;           // Time of the report
+    vrpn_int32 num_sensors;            // How many sensors are in the frame
+    const vrpn_int32 *sensor;          // Which sensors are reporting
+    const vrpn_Tracker_Pos *pos;       // Position of each sensor
+    const vrpn_Tracker_Quat *quat;     // Orientation of each sensor
+    const vrpn_Tracker_Pos *vel;       // Velocity of each, NULL if not sent
+    const vrpn_Tracker_Quat *vel_quat; // Rotation of each per vel_quat_dt
+    const vrpn_float64 *vel_quat_dt;   // delta time (in secs) for vel_quat
+} vrpn_TRACKERFRAMECB;
+typedef void(VRPN_CALLBACK *vrpn_TRACKERFRAMEHANDLER)(
+    void *userdata, const vrpn_TRACKERFRAMECB info);
+
 typedef struct _vrpn_TRACKERWORKSPACECB {
     struct timeval msg_time;       // Time of the report
     vrpn_float64 workspace_min[3]; // minimum corner of box (tracker CS)
@@ -480,17 +553,81 @@ public:
         return d_tracker2roomchange_list.unregister_handler(userdata, handler);
     };
 
+    // (un)Register a callback handler to handle a multi-sensor frame
+    virtual int register_change_handler(void *userdata,
+                                        vrpn_TRACKERFRAMEHANDLER handler)
+    {
+        return d_framechange_list.register_handler(userdata, handler);
+    };
+    virtual int unregister_change_handler(void *userdata,
+                                          vrpn_TRACKERFRAMEHANDLER handler)
+    {
+        return d_framechange_list.unregister_handler(userdata, handler);
+    };
+
 protected:
-    // Callbacks with one per sensor (plus one for "all")
+    // Callbacks for all sensors
     vrpn_Tracker_Sensor_Callbacks all_sensor_callbacks;
-    vrpn_Tracker_Sensor_Callbacks *sensor_callbacks;
-    unsigned num_sensor_callbacks;
+
+    // Callbacks for particular sensors, indexed by sensor number.  An entry
+    // stays NULL until a handler is registered for that sensor, so reports
+    // never allocate, and growing the table only copies pointers.  Most
+    // clients only register for all sensors, leaving the table empty.
+    vrpn_vector<vrpn_Tracker_Sensor_Callbacks *> d_sensorCallbacks;
+
+    /// Returns the callbacks for sensor, adding them to the table if they
+    /// are not there yet.  Returns NULL if out of memory.
+    vrpn_Tracker_Sensor_Callbacks *make_sensor_callbacks(vrpn_int32 sensor);
+
+    /// Returns the callbacks for sensor, or NULL if no handler has been
+    /// registered for it.
+    vrpn_Tracker_Sensor_Callbacks *find_sensor_callbacks(vrpn_int32 sensor) const
+    {
+        if ((sensor < 0) ||
+            (static_cast<size_t>(sensor) >= d_sensorCallbacks.size())) {
+            return NULL;
+        }
+        return d_sensorCallbacks[sensor];
+    }
+
+    /// The names derived classes used when the table was an array of
+    /// callbacks, kept so that they still build; they now call functions.
+    /// sensor_callbacks(i) is NULL for a sensor below
+    /// num_sensor_callbacks() that has no callbacks yet, unless
+    /// ensure_enough_sensor_callbacks() has made them.
+    /// @{
+    vrpn_Tracker_Sensor_Callbacks *sensor_callbacks(unsigned sensor) const
+    {
+        return find_sensor_callbacks(static_cast<vrpn_int32>(sensor));
+    }
+    unsigned num_sensor_callbacks(void) const
+    {
+        return static_cast<unsigned>(d_sensorCallbacks.size());
+    }
+    /// Makes callbacks for every sensor below num.  Returns false if out
+    /// of memory.
     bool ensure_enough_sensor_callbacks(unsigned num);
+    /// @}
 
     // Callbacks that are one per tracker
     vrpn_Callback_List<vrpn_TRACKERTRACKER2ROOMCB> d_tracker2roomchange_list;
     vrpn_Callback_List<vrpn_TRACKERWORKSPACECB> d_workspacechange_list;
+    vrpn_Callback_List<vrpn_TRACKERFRAMECB> d_framechange_list;
+
+    /// Call the handlers for all sensors and then those for tp.sensor.
+    /// Returns -1 if tp.sensor is out of range.
+    /// @{
+    int call_change_handlers(const vrpn_TRACKERCB &tp);
+    int call_vel_change_handlers(const vrpn_TRACKERVELCB &tp);
+    /// @}
 
+    /// Tell the server that we understand frame messages.
+    void request_frames(void);
+
+    static int VRPN_CALLBACK
+    handle_connection_made(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_frame_message(void *userdata, vrpn_HANDLERPARAM p);
     static int VRPN_CALLBACK
     handle_change_message(void *userdata, vrpn_HANDLERPARAM p);
     static int VRPN_CALLBACK
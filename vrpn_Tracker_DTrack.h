@@ -137,9 +137,9 @@ class VRPN_API vrpn_Tracker_DTrack : public vrpn_Tracker, public vrpn_Button_Fil
 	float joy_incPerSec;             // increase of 'joystick' channel (in 1/sec)
 
 	int dtrack2vrpn_marker(int id, const char* str_dtrack, int id_dtrack,
-	                     const float* loc, struct timeval timestamp);
+	                     const float* loc);
 	int dtrack2vrpn_body(int id, const char* str_dtrack, int id_dtrack,
-	                     const float* loc, const float* rot, struct timeval timestamp);
+	                     const float* loc, const float* rot);
 	int dtrack2vrpn_flystickbuttons(int id, int id_dtrack,
 	                                int num_but, const int* but, struct timeval timestamp);
 	int dtrack2vrpn_flystickanalogs(int id, int id_dtrack,
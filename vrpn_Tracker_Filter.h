@@ -49,14 +49,22 @@ class VRPN_API vrpn_Tracker_FilterOneEuro: public vrpn_Tracker {
 
   private:
     int  d_channels;                    // How many channels on our tracker?
-    vrpn_OneEuroFilterVec *d_filters;   // Set of position filters, one/channel
-    vrpn_OneEuroFilterQuat *d_qfilters; // Set of orientation filters, one/channel
+    vrpn_OneEuroFilterBank<> d_bank;    // Position and orientation filters for all channels
     struct timeval  *d_last_report_times;     // Last time of report for each tracker.
+    vrpn_vector<bool> d_in_frame;       // Report at the last time already filtered in a frame
+    vrpn_vector<vrpn_float64> d_frame_dt, d_frame_pos, d_frame_quat; // Space to filter a frame
     vrpn_Tracker_Remote   *d_listen_tracker;  // Tracker we get our reports from
 
     // Callback handler to deal with getting messages from the tracker we're
     // listening to.  It filters them and then sends them on.
     static void VRPN_CALLBACK handle_tracker_update(void *userdata, const vrpn_TRACKERCB info);
+
+    // When the tracker we're listening to sends whole frames, this filters
+    // all of the channels in each one together and sends them on as a frame.
+    static void VRPN_CALLBACK handle_tracker_frame(void *userdata, const vrpn_TRACKERFRAMECB info);
+
+    // Unmark the first count sensors of a frame we aren't filtering after all.
+    void clear_in_frame(const vrpn_int32 *sensors, vrpn_int32 count);
 };
 
 
@@ -64,9 +72,17 @@ class VRPN_API vrpn_Tracker_FilterOneEuro: public vrpn_Tracker {
 // of the specified sensors from the specified tracker.  If there are no orientation
 // velocity reports, use the two most-recent poses to estimate angular velocity and
 // use that to predict.
+//  The angular velocity is kept as a rotation vector per second (the log of the
+// rotation quaternion divided by its interval), so a prediction over any horizon
+// is one q_exp() and one q_mult(), with no looping and no allocation.
 //  Note: This class does not try to listen for angular acceleration.
-//  Note: This class does not try to forward-predict position, it leaves that
-// part of the tracker message alone.
+//  Note: Position is left alone unless predictPosition is set, in which case it
+// is moved along the linear velocity from velocity reports (or estimated from
+// the last two poses, if estimateVelocity is set and there are none).
+//  Note: If batch is set and the original tracker sends whole frames (see
+// vrpn_Tracker::report_frame()), all of the sensors in each frame are predicted
+// in one pass and sent back out as one frame.  Trackers that report each sensor
+// in a message of its own are predicted one sensor at a time either way.
 
 class VRPN_API vrpn_Tracker_DeadReckoning_Rotation : public vrpn_Tracker_Server
 {
@@ -80,6 +96,8 @@ class VRPN_API vrpn_Tracker_DeadReckoning_Rotation : public vrpn_Tracker_Server
         , vrpn_float64 predictionTime = 1.0 / 60.0   //< How far to predict into the future?
         , bool estimateVelocity = true //< Should we estimate angular velocity if we don't get it?
                                        //< If false, this is basically just a pass-through filter, but estimating velocity can be choppy.
+        , bool predictPosition = false //< Should we also predict position from linear velocity?
+        , bool batch = false           //< Should we predict whole frames in one pass when they come?
         );
 
     ~vrpn_Tracker_DeadReckoning_Rotation();
@@ -99,11 +117,14 @@ class VRPN_API vrpn_Tracker_DeadReckoning_Rotation : public vrpn_Tracker_Server
 
     typedef struct {
         bool d_receivedAngularVelocityReport;   //< If we get these, we don't estimate them
-        vrpn_float64 d_rotationAmount[4];       //< How far did we rotate in the specified interval
-        double d_rotationInterval;              //< Interval over which we rotated
+        bool d_receivedLinearVelocityReport;    //< Likewise for position
+        vrpn_float64 d_angularVelocity[3];      //< Log of the rotation per second (half-angle rotation vector)
+        vrpn_float64 d_linearVelocity[3];       //< Change in position per second
         vrpn_float64 d_lastPosition[3];         //< What was our last reported position?
         vrpn_float64 d_lastOrientation[4];      //< What was our last orientation?
         struct timeval d_lastReportTime;        //< When did we receive it?
+        bool d_inFrame;                         //< Pose for d_lastReportTime already sent in a batch
+        bool d_velocityInFrame;                 //< Velocity for d_lastReportTime already passed on in a batch
     } RotationState;
     vrpn_vector<RotationState>  d_rotationStates;   //< State of rotation of each sensor.
     
@@ -112,6 +133,20 @@ class VRPN_API vrpn_Tracker_DeadReckoning_Rotation : public vrpn_Tracker_Server
         const vrpn_TRACKERCB info);
     static void VRPN_CALLBACK handle_tracker_velocity_report(void *userdata,
         const vrpn_TRACKERVELCB info);
+    static void VRPN_CALLBACK handle_tracker_frame(void *userdata,
+        const vrpn_TRACKERFRAMECB info);
+
+    /// Fold a new pose or velocity into the state of its sensor.
+    void updatePose(RotationState &state, const struct timeval &when,
+                    const vrpn_float64 pos[3], const vrpn_float64 quat[4]);
+    void updateVelocity(RotationState &state, const vrpn_float64 vel[3],
+                        const vrpn_float64 vel_quat[4], vrpn_float64 vel_quat_dt);
+
+    /// Compute the prediction for a sensor from its state.  Returns false if
+    // there is nothing to send yet.  when is set to the time the prediction is
+    // for, which is the last report time if we are only passing reports along.
+    bool predict(const RotationState &state, struct timeval &when,
+                 vrpn_float64 pos[3], vrpn_float64 quat[4]) const;
 
     /// Send a prediction based on the time of the new information; date the
     // prediction in the future from the original message by the prediction
@@ -119,5 +154,7 @@ class VRPN_API vrpn_Tracker_DeadReckoning_Rotation : public vrpn_Tracker_Server
     void sendNewPrediction(vrpn_int32 sensor);
 
     bool d_estimateVelocity;
+    bool d_predictPosition;
+    bool d_batch;
 };
 
@@ -37,6 +37,12 @@ public:
 
 	void mainloop();
 
+	/*
+	 * Only runs when a packet has arrived; see mainloop()
+	 */
+	void get_wait_descriptors(vrpn_vector<int>& fds);
+	vrpn_int32 max_wait_usecs(void) { return -1; }
+
 	enum {
 		TILT_TRACKER_ID = 0,
 	};
@@ -50,6 +56,7 @@ private:
 	int _network_receive(void *buffer, int maxlen, int tout_us);
 	void _network_release();
 	vrpn_SOCKET _socket;
+	bool _woken_on_socket; // A server is waiting on _socket for us
 	enum {
 		_NETWORK_BUFFER_SIZE = 2000,
 
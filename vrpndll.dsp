@@ -160,6 +160,10 @@ SOURCE=.\vrpn_Connection.C
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_DeviceScheduler.C
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Dial.C
 # End Source File
 # Begin Source File
@@ -312,6 +316,10 @@ SOURCE=.\vrpn_SharedObject.C
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_ShmConnection.C
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Sound.C
 # End Source File
 # Begin Source File
@@ -328,6 +336,10 @@ SOURCE=.\vrpn_Streaming_Arduino.C
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_Telemetry.C
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Tng3.C
 # End Source File
 # Begin Source File
@@ -492,6 +504,10 @@ SOURCE=.\vrpn_Connection.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_DeviceScheduler.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Dial.h
 # End Source File
 # Begin Source File
@@ -640,6 +656,10 @@ SOURCE=.\vrpn_SharedObject.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_ShmConnection.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Sound.h
 # End Source File
 # Begin Source File
@@ -656,6 +676,10 @@ SOURCE=.\vrpn_Streaming_Arduino.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\vrpn_Telemetry.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\vrpn_Tng3.h
 # End Source File
 # Begin Source File